@@ -2484,6 +2484,9 @@ Amr::coarseTimeStep (Real stop_time)
 #endif
 
     BL_PROFILE_ADD_STEP(level_steps[0]);
+#ifdef AMREX_TINY_PROFILING
+    TinyProfiler::RecordTimeSeries(level_steps[0], cumtime);
+#endif
     BL_PROFILE_REGION_STOP("Amr::coarseTimeStep()");
     BL_COMM_PROFILE_NAMETAG(stepName.str());
     //BL_PROFILE_FLUSH();
@@ -389,6 +389,10 @@ amrex::Initialize (int& argc, char**& argv, bool build_parm_parse,
 	pp.query("v", system::verbose);
 	pp.query("verbose", system::verbose);
         pp.query("regtest_reduction", system::regtest_reduction);
+#ifndef AMREX_USE_GPU
+        pp.query("omp_parallel_for", Gpu::omp_parallel_for);
+        pp.query("omp_parallel_for_min_size", Gpu::omp_parallel_for_min_size);
+#endif
         pp.query("signal_handling", system::signal_handling);
         pp.query("throw_exception", system::throw_exception);
         pp.query("call_addr2line", system::call_addr2line);
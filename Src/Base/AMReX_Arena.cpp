@@ -11,6 +11,9 @@
 #include <AMReX_ParmParse.H>
 #include <AMReX_Gpu.H>
 
+#include <atomic>
+#include <cstdint>
+#include <utility>
 #include <sys/mman.h>
 
 namespace amrex {
@@ -28,6 +31,59 @@ namespace {
     long buddy_allocator_size = 0L;
     long the_arena_init_size = 0L;
     bool abort_on_out_of_gpu_memory = false;
+    bool the_arena_use_hugepages = false;
+
+#ifndef AMREX_USE_GPU
+    constexpr std::size_t huge_page_size = 2UL*1024UL*1024UL;
+
+    // Memory backed by huge pages is physically contiguous, so arrays at the same
+    // offset in different allocations map to the same cache sets.  We shift the
+    // start of successive allocations by multiples of a page plus a cache line.
+    constexpr std::size_t hugepage_color_size = 4096UL + 64UL;
+    constexpr unsigned int hugepage_num_colors = 31;
+    std::atomic<unsigned int> hugepage_color{0};
+
+    // The huge page aligned region that contains [p, p+nbytes)
+    std::pair<char*,std::size_t> hugepage_region (void* p, std::size_t nbytes)
+    {
+        char* base = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(p)
+                                             / huge_page_size * huge_page_size);
+        const std::size_t offset = static_cast<char*>(p) - base;
+        return std::make_pair(base, amrex::aligned_size(huge_page_size, nbytes+offset));
+    }
+
+    // Try explicit huge pages first.  They are only available if the system has
+    // reserved them (vm.nr_hugepages), so fall back to asking for transparent huge
+    // pages, and the kernel may still use normal pages.
+    void* mmap_hugepages (std::size_t nbytes)
+    {
+        const std::size_t color = (hugepage_color++ % hugepage_num_colors) * hugepage_color_size;
+        const std::size_t sz = amrex::aligned_size(huge_page_size, nbytes+color);
+        char* q = nullptr;
+#ifdef MAP_HUGETLB
+        void* p = mmap(nullptr, sz, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) q = static_cast<char*>(p);
+#endif
+        if (q == nullptr) {
+            // Transparent huge pages need a huge page aligned range, so we
+            // allocate more and unmap the unaligned head and tail.
+            void* pa = mmap(nullptr, sz + huge_page_size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (pa == MAP_FAILED) return nullptr;
+            q = static_cast<char*>(pa);
+            const std::size_t head = (huge_page_size - reinterpret_cast<uintptr_t>(q)
+                                      % huge_page_size) % huge_page_size;
+            if (head > 0) munmap(q, head);
+            munmap(q + head + sz, huge_page_size - head);
+            q += head;
+#ifdef MADV_HUGEPAGE
+            madvise(q, sz, MADV_HUGEPAGE);
+#endif
+        }
+        return q + color;
+    }
+#endif
 }
 
 const std::size_t Arena::align_size;
@@ -98,7 +154,11 @@ Arena::allocate_system (std::size_t nbytes)
         }
     }
 #else
-    p = std::malloc(nbytes);
+    if (arena_info.use_hugepages) {
+        p = mmap_hugepages(nbytes);
+    } else {
+        p = std::malloc(nbytes);
+    }
     if (p && arena_info.device_use_hostalloc) mlock(p, nbytes);
 #endif
     if (p == nullptr) amrex::Abort("Sorry, malloc failed");
@@ -130,7 +190,14 @@ Arena::deallocate_system (void* p, std::size_t nbytes)
     }
 #else
     if (p && arena_info.device_use_hostalloc) munlock(p, nbytes);
-    std::free(p);
+    if (arena_info.use_hugepages) {
+        if (p) {
+            auto r = hugepage_region(p, nbytes);
+            munmap(r.first, r.second);
+        }
+    } else {
+        std::free(p);
+    }
 #endif
 }
 
@@ -151,6 +218,7 @@ Arena::Initialize ()
     pp.query("buddy_allocator_size", buddy_allocator_size);
     pp.query("the_arena_init_size", the_arena_init_size);
     pp.query("abort_on_out_of_gpu_memory", abort_on_out_of_gpu_memory);
+    pp.query("the_arena_use_hugepages", the_arena_use_hugepages);
 
 #ifdef AMREX_USE_GPU
     if (use_buddy_allocator)
@@ -169,7 +237,11 @@ Arena::Initialize ()
 #endif
     {
 #if defined(BL_COALESCE_FABS) || defined(AMREX_USE_GPU)
-        the_arena = new CArena(0, ArenaInfo().SetPreferred());
+        ArenaInfo info = ArenaInfo().SetPreferred();
+#ifndef AMREX_USE_GPU
+        if (the_arena_use_hugepages) info.SetHugePages();
+#endif
+        the_arena = new CArena(0, info);
 #ifdef AMREX_USE_GPU
         if (the_arena_init_size <= 0) {
             the_arena_init_size = Gpu::Device::totalGlobalMem() / 4L * 3L;
@@ -181,7 +253,12 @@ Arena::Initialize ()
         the_arena->free(p);
 #endif
 #else
-        the_arena = new BArena;
+        if (the_arena_use_hugepages) {
+            // The huge pages are pooled, because mmap is too expensive for every fab.
+            the_arena = new CArena(0, ArenaInfo().SetHugePages());
+        } else {
+            the_arena = new BArena;
+        }
 #endif
     }
 
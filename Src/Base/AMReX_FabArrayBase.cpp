@@ -24,6 +24,7 @@ namespace amrex {
 // Set default values in Initialize()!!!
 //
 int     FabArrayBase::MaxComp;
+bool    FabArrayBase::numa_first_touch;
 
 #if defined(AMREX_USE_GPU) && defined(AMREX_USE_GPU_PRAGMA)
 
@@ -90,6 +91,7 @@ FabArrayBase::Initialize ()
     // Set default values here!!!
     //
     FabArrayBase::MaxComp           = 25;
+    FabArrayBase::numa_first_touch  = false;
 
     ParmParse pp("fabarray");
 
@@ -111,6 +113,7 @@ FabArrayBase::Initialize ()
     }
 
     pp.query("maxcomp",             FabArrayBase::MaxComp);
+    pp.query("numa_first_touch",    FabArrayBase::numa_first_touch);
 
     if (MaxComp < 1) {
         MaxComp = 1;
@@ -224,6 +227,36 @@ FabArrayBase::fabbox (int K) const noexcept
     return amrex::grow(boxarray[K], n_grow);
 }
 
+long
+FabArrayBase::numLocalPts (const IntVect& nghost) const noexcept
+{
+    long r = 0;
+    for (int K : indexArray) {
+        r += amrex::grow(boxarray[K], nghost).numPts();
+    }
+    return r;
+}
+
+long
+FabArrayBase::numPtsOfCopyComTags (const CopyComTagsContainer& tags) noexcept
+{
+    long r = 0;
+    for (auto const& tag : tags) {
+        r += tag.dbox.numPts();
+    }
+    return r;
+}
+
+long
+FabArrayBase::numPtsOfCopyComTags (const MapOfCopyComTagContainers& m) noexcept
+{
+    long r = 0;
+    for (auto const& kv : m) {
+        r += numPtsOfCopyComTags(kv.second);
+    }
+    return r;
+}
+
 long
 FabArrayBase::bytesOfMapOfCopyComTagContainers (const FabArrayBase::MapOfCopyComTagContainers& m)
 {
@@ -569,7 +602,7 @@ FabArrayBase::flushCPCache ()
 const FabArrayBase::CPC&
 FabArrayBase::getCPC (const IntVect& dstng, const FabArrayBase& src, const IntVect& srcng, const Periodicity& period) const
 {
-    BL_PROFILE("FabArrayBase::getCPC()");
+    BL_PROFILE_SITE("FabArrayBase::getCPC()");
 
     BL_ASSERT(getBDKey() == m_bdkey);
     BL_ASSERT(src.getBDKey() == src.m_bdkey);
@@ -1041,7 +1074,7 @@ const FabArrayBase::FB&
 FabArrayBase::getFB (const IntVect& nghost, const Periodicity& period,
                      bool cross, bool enforce_periodicity_only) const
 {
-    BL_PROFILE("FabArrayBase::getFB()");
+    BL_PROFILE_SITE("FabArrayBase::getFB()");
 
     BL_ASSERT(getBDKey() == m_bdkey);
     std::pair<FBCacheIter,FBCacheIter> er_it = m_TheFBCache.equal_range(m_bdkey);
@@ -1171,7 +1204,7 @@ FabArrayBase::TheFPinfo (const FabArrayBase& srcfa,
                          const Box&          cdomain,
                          const EB2::IndexSpace* index_space)
 {
-    BL_PROFILE("FabArrayBase::TheFPinfo()");
+    BL_PROFILE_SITE("FabArrayBase::TheFPinfo()");
 
     const BDKey& srckey = srcfa.getBDKey();
     const BDKey& dstkey = dstfa.getBDKey();
@@ -1336,7 +1369,7 @@ FabArrayBase::TheCFinfo (const FabArrayBase& finefa,
                          bool                include_periodic,
                          bool                include_physbndry)
 {
-    BL_PROFILE("FabArrayBase::TheCFinfo()");
+    BL_PROFILE_SITE("FabArrayBase::TheCFinfo()");
 
     const BDKey& key = finefa.getBDKey();
     auto er_it = m_TheCrseFineCache.equal_range(key);
@@ -18,6 +18,9 @@ ScopedDefaultStream::~ScopedDefaultStream ()
     Device::setStream(m_prev_stream);
 }
 
+#else
+bool omp_parallel_for = false;
+long omp_parallel_for_min_size = 4096;
 #endif
 
 }
@@ -41,7 +41,9 @@ MultiFab::Dot (const MultiFab& x, int xcomp,
     BL_ASSERT(x.DistributionMap() == y.DistributionMap());
     BL_ASSERT(x.nGrow() >= nghost and y.nGrow() >= nghost);
 
-    BL_PROFILE("MultiFab::Dot()");
+    BL_PROFILE_SITE("MultiFab::Dot()");
+    BL_PROFILE_WORK(2.0*sizeof(Real)*numcomp*x.numLocalPts(IntVect(nghost)),
+                    2.0*numcomp*x.numLocalPts(IntVect(nghost)));
 
     Real sm = amrex::ReduceSum(x, y, nghost,
     [=] AMREX_GPU_HOST_DEVICE (Box const& bx, Array4<Real const> const& xfab, Array4<Real const> const& yfab) -> Real
@@ -64,6 +66,10 @@ MultiFab::Dot (const MultiFab& x, int xcomp, int numcomp, int nghost, bool local
 {
     BL_ASSERT(x.nGrow() >= nghost); 
 
+    BL_PROFILE_SITE("MultiFab::Dot()");
+    BL_PROFILE_WORK(1.0*sizeof(Real)*numcomp*x.numLocalPts(IntVect(nghost)),
+                    2.0*numcomp*x.numLocalPts(IntVect(nghost)));
+
     Real sm = amrex::ReduceSum(x, nghost,
     [=] AMREX_GPU_HOST_DEVICE (Box const& bx, Array4<Real const> const& xfab) -> Real
     {
@@ -95,6 +101,10 @@ MultiFab::Dot (const iMultiFab& mask,
     BL_ASSERT(x.nGrow() >= nghost and y.nGrow() >= nghost);
     BL_ASSERT(mask.nGrow() >= nghost);
 
+    BL_PROFILE_SITE("MultiFab::Dot()");
+    BL_PROFILE_WORK((2.0*sizeof(Real)*numcomp+sizeof(int))*x.numLocalPts(IntVect(nghost)),
+                    3.0*numcomp*x.numLocalPts(IntVect(nghost)));
+
     Real sm = amrex::ReduceSum(x, y, mask, nghost,
     [=] AMREX_GPU_HOST_DEVICE (Box const& bx, Array4<Real const> const& xfab,
                                Array4<Real const> const& yfab,
@@ -115,6 +125,78 @@ MultiFab::Dot (const iMultiFab& mask,
     return sm;
 }
 
+Vector<Real>
+MultiFab::Dot (const MultiFab& x, int xcomp,
+               const Vector<MultiFab const*>& y, int ycomp,
+               int numcomp, int nghost, bool local)
+{
+    BL_ASSERT(x.nGrow() >= nghost);
+
+    BL_PROFILE_SITE("MultiFab::Dot()");
+    BL_PROFILE_WORK((1.0+y.size())*sizeof(Real)*numcomp*x.numLocalPts(IntVect(nghost)),
+                    2.0*y.size()*numcomp*x.numLocalPts(IntVect(nghost)));
+
+    const int ny = y.size();
+    Vector<Real> sm(ny, 0.0);
+
+#ifdef AMREX_USE_GPU
+    if (Gpu::inLaunchRegion())
+    {
+        // One reduction for each of them
+        for (int m = 0; m < ny; ++m) {
+            sm[m] = MultiFab::Dot(x, xcomp, *y[m], ycomp, numcomp, nghost, true);
+        }
+    }
+    else
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp parallel if (!system::regtest_reduction)
+#endif
+        {
+            Vector<Real> tsm(ny, 0.0);
+            Vector<Array4<Real const> > yfab(ny);
+            for (MFIter mfi(x,true); mfi.isValid(); ++mfi)
+            {
+                const Box& bx = mfi.growntilebox(nghost);
+                const auto lo = amrex::lbound(bx);
+                const auto hi = amrex::ubound(bx);
+                auto const& xfab = x.const_array(mfi);
+                for (int m = 0; m < ny; ++m) {
+                    BL_ASSERT(y[m]->boxArray() == x.boxArray() && y[m]->nGrow() >= nghost);
+                    yfab[m] = y[m]->const_array(mfi);
+                }
+                // A row of x stays in cache for all of the y.
+                for (int n = 0; n < numcomp; ++n) {
+                for (int k = lo.z; k <= hi.z; ++k) {
+                for (int j = lo.y; j <= hi.y; ++j) {
+                    for (int m = 0; m < ny; ++m) {
+                        Array4<Real const> const& ym = yfab[m];
+                        Real t = 0.0;
+                        AMREX_PRAGMA_SIMD
+                        for (int i = lo.x; i <= hi.x; ++i) {
+                            t += xfab(i,j,k,xcomp+n) * ym(i,j,k,ycomp+n);
+                        }
+                        tsm[m] += t;
+                    }
+                }}}
+            }
+#ifdef _OPENMP
+#pragma omp critical (multifab_dot)
+#endif
+            for (int m = 0; m < ny; ++m) {
+                sm[m] += tsm[m];
+            }
+        }
+    }
+
+    if (!local && ny > 0) {
+        ParallelAllReduce::Sum(sm.dataPtr(), ny, ParallelContext::CommunicatorSub());
+    }
+
+    return sm;
+}
+
 void
 MultiFab::Add (MultiFab& dst, const MultiFab& src,
                int srccomp, int dstcomp, int numcomp, int nghost)
@@ -130,7 +212,7 @@ MultiFab::Add (MultiFab& dst, const MultiFab& src,
     BL_ASSERT(dst.distributionMap == src.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and src.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::Add()");
+    BL_PROFILE_SITE("MultiFab::Add()");
 
     amrex::Add(dst, src, srccomp, dstcomp, numcomp, nghost);
 }
@@ -150,7 +232,7 @@ MultiFab::Copy (MultiFab& dst, const MultiFab& src,
     BL_ASSERT(dst.distributionMap == src.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::Copy()");
+    BL_PROFILE_SITE("MultiFab::Copy()");
     
     amrex::Copy(dst,src,srccomp,dstcomp,numcomp,nghost);
 }
@@ -197,7 +279,7 @@ MultiFab::Swap (MultiFab& dst, MultiFab& src,
     BL_ASSERT(dst.distributionMap == src.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and src.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::Swap()");
+    BL_PROFILE_SITE("MultiFab::Swap()");
 
     // We can take a shortcut and do a std::swap if we're swapping all of the data
     // and they are allocated in the same Arena.
@@ -253,7 +335,7 @@ MultiFab::Subtract (MultiFab& dst, const MultiFab& src,
     BL_ASSERT(dst.distributionMap == src.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and src.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::Subtract()");
+    BL_PROFILE_SITE("MultiFab::Subtract()");
 
     amrex::Subtract(dst,src,srccomp,dstcomp,numcomp,nghost);
 }
@@ -273,7 +355,7 @@ MultiFab::Multiply (MultiFab& dst, const MultiFab& src,
     BL_ASSERT(dst.distributionMap == src.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and src.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::Multiply()");
+    BL_PROFILE_SITE("MultiFab::Multiply()");
 
     amrex::Multiply(dst,src,srccomp,dstcomp,numcomp,nghost);
 }
@@ -293,7 +375,7 @@ MultiFab::Divide (MultiFab& dst, const MultiFab& src,
     BL_ASSERT(dst.distributionMap == src.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and src.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::Divide()");
+    BL_PROFILE_SITE("MultiFab::Divide()");
 
     amrex::Divide(dst,src,srccomp,dstcomp,numcomp,nghost);
 }
@@ -313,7 +395,9 @@ MultiFab::Saxpy (MultiFab& dst, Real a, const MultiFab& src,
     BL_ASSERT(dst.distributionMap == src.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and src.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::Saxpy()");
+    BL_PROFILE_SITE("MultiFab::Saxpy()");
+    BL_PROFILE_WORK(3.0*sizeof(Real)*numcomp*dst.numLocalPts(nghost),
+                    2.0*numcomp*dst.numLocalPts(nghost));
 
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -348,7 +432,9 @@ MultiFab::Xpay (MultiFab& dst, Real a, const MultiFab& src,
     BL_ASSERT(dst.distributionMap == src.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and src.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::Xpay()");
+    BL_PROFILE_SITE("MultiFab::Xpay()");
+    BL_PROFILE_WORK(3.0*sizeof(Real)*numcomp*dst.numLocalPts(nghost),
+                    2.0*numcomp*dst.numLocalPts(nghost));
 
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -388,7 +474,9 @@ MultiFab::LinComb (MultiFab& dst,
     BL_ASSERT(dst.distributionMap == y.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and x.nGrowVect().allGE(nghost) and y.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::LinComb()");
+    BL_PROFILE_SITE("MultiFab::LinComb()");
+    BL_PROFILE_WORK(3.0*sizeof(Real)*numcomp*dst.numLocalPts(nghost),
+                    3.0*numcomp*dst.numLocalPts(nghost));
 
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -409,6 +497,130 @@ MultiFab::LinComb (MultiFab& dst,
     }
 }
 
+void
+MultiFab::LinComb (MultiFab& dst,
+                   Real a, const MultiFab& x, int xcomp,
+                   Real b, const MultiFab& y, int ycomp,
+                   Real c, const MultiFab& z, int zcomp,
+                   int dstcomp, int numcomp, int nghost)
+{
+    BL_ASSERT(dst.boxArray() == x.boxArray() && dst.boxArray() == y.boxArray() &&
+              dst.boxArray() == z.boxArray());
+    BL_ASSERT(dst.distributionMap == x.distributionMap && dst.distributionMap == y.distributionMap &&
+              dst.distributionMap == z.distributionMap);
+    BL_ASSERT(dst.nGrow() >= nghost and x.nGrow() >= nghost and y.nGrow() >= nghost and
+              z.nGrow() >= nghost);
+
+    BL_PROFILE_SITE("MultiFab::LinComb()");
+    BL_PROFILE_WORK(4.0*sizeof(Real)*numcomp*dst.numLocalPts(IntVect(nghost)),
+                    5.0*numcomp*dst.numLocalPts(IntVect(nghost)));
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(dst,TilingIfNotGPU()); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.growntilebox(nghost);
+
+        if (bx.ok()) {
+            auto const xfab =   x.array(mfi);
+            auto const yfab =   y.array(mfi);
+            auto const zfab =   z.array(mfi);
+            auto       dfab = dst.array(mfi);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_4D ( bx, numcomp, i, j, k, n,
+            {
+                dfab(i,j,k,dstcomp+n) = a*xfab(i,j,k,xcomp+n) + b*yfab(i,j,k,ycomp+n)
+                    +                   c*zfab(i,j,k,zcomp+n);
+            });
+        }
+    }
+}
+
+Real
+MultiFab::LinCombNorm0 (MultiFab& dst,
+                        Real a, const MultiFab& x, int xcomp,
+                        Real b, const MultiFab& y, int ycomp,
+                        int dstcomp, int numcomp, int nghost, bool local)
+{
+    BL_ASSERT(dst.boxArray() == x.boxArray() && dst.boxArray() == y.boxArray());
+    BL_ASSERT(dst.distributionMap == x.distributionMap && dst.distributionMap == y.distributionMap);
+    BL_ASSERT(dst.nGrow() >= nghost and x.nGrow() >= nghost and y.nGrow() >= nghost);
+
+    BL_PROFILE_SITE("MultiFab::LinCombNorm0()");
+    BL_PROFILE_WORK(3.0*sizeof(Real)*numcomp*dst.numLocalPts(IntVect(nghost)),
+                    4.0*numcomp*dst.numLocalPts(IntVect(nghost)));
+
+    Real nm0 = 0.0;
+
+#ifdef AMREX_USE_GPU
+    if (Gpu::inLaunchRegion())
+    {
+        ReduceOps<ReduceOpMax> reduce_op;
+        ReduceData<Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+        for (MFIter mfi(dst); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.growntilebox(nghost);
+            const Box& vbx = mfi.validbox();
+            auto const xfab =   x.array(mfi);
+            auto const yfab =   y.array(mfi);
+            auto       dfab = dst.array(mfi);
+            reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                const bool valid = vbx.contains(IntVect(AMREX_D_DECL(i,j,k)));
+                Real r = 0.0;
+                for (int n = 0; n < numcomp; ++n) {
+                    const Real v = a*xfab(i,j,k,xcomp+n) + b*yfab(i,j,k,ycomp+n);
+                    dfab(i,j,k,dstcomp+n) = v;
+                    if (valid) r = amrex::max(r, amrex::Math::abs(v));
+                }
+                return {r};
+            });
+        }
+
+        nm0 = amrex::get<0>(reduce_data.value());
+    }
+    else
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp parallel if (!system::regtest_reduction) reduction(max:nm0)
+#endif
+        for (MFIter mfi(dst,true); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.growntilebox(nghost);
+            const Box& vbx = mfi.tilebox();
+            auto const xfab =   x.array(mfi);
+            auto const yfab =   y.array(mfi);
+            auto       dfab = dst.array(mfi);
+            if (nghost == 0) {
+                AMREX_LOOP_4D(bx, numcomp, i, j, k, n,
+                {
+                    const Real v = a*xfab(i,j,k,xcomp+n) + b*yfab(i,j,k,ycomp+n);
+                    dfab(i,j,k,dstcomp+n) = v;
+                    nm0 = amrex::max(nm0, amrex::Math::abs(v));
+                });
+            } else {
+                amrex::LoopConcurrentOnCpu(bx, numcomp, [&] (int i, int j, int k, int n) noexcept
+                {
+                    dfab(i,j,k,dstcomp+n) = a*xfab(i,j,k,xcomp+n) + b*yfab(i,j,k,ycomp+n);
+                });
+                // The tile is still in cache.
+                AMREX_LOOP_4D(vbx, numcomp, i, j, k, n,
+                {
+                    nm0 = amrex::max(nm0, amrex::Math::abs(dfab(i,j,k,dstcomp+n)));
+                });
+            }
+        }
+    }
+
+    if (!local) ParallelAllReduce::Max(nm0, ParallelContext::CommunicatorSub());
+
+    return nm0;
+}
+
 void
 MultiFab::AddProduct (MultiFab& dst,
                       const MultiFab& src1, int comp1,
@@ -430,7 +642,9 @@ MultiFab::AddProduct (MultiFab& dst,
     BL_ASSERT(dst.distributionMap == src2.distributionMap);
     BL_ASSERT(dst.nGrowVect().allGE(nghost) and src1.nGrowVect().allGE(nghost) and src2.nGrowVect().allGE(nghost));
 
-    BL_PROFILE("MultiFab::AddProduct()");
+    BL_PROFILE_SITE("MultiFab::AddProduct()");
+    BL_PROFILE_WORK(4.0*sizeof(Real)*numcomp*dst.numLocalPts(nghost),
+                    2.0*numcomp*dst.numLocalPts(nghost));
 
 #ifdef _OPENMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -955,6 +1169,9 @@ MultiFab::maxIndex (int comp, int nghost) const
 Real
 MultiFab::norm0 (const iMultiFab& mask, int comp, int nghost, bool local) const
 {
+    BL_PROFILE_SITE("MultiFab::norm0()");
+    BL_PROFILE_WORK((sizeof(Real)+sizeof(int))*numLocalPts(IntVect(nghost)), 0.0);
+
     Real nm0 = amrex::ReduceMax(*this, mask, nghost,
     [=] AMREX_GPU_HOST_DEVICE (Box const& bx, Array4<Real const> const& fab,
                                Array4<int const> const& mskfab) -> Real
@@ -975,6 +1192,9 @@ MultiFab::norm0 (const iMultiFab& mask, int comp, int nghost, bool local) const
 Real
 MultiFab::norm0 (int comp, int nghost, bool local, bool ignore_covered ) const
 {
+    BL_PROFILE_SITE("MultiFab::norm0()");
+    BL_PROFILE_WORK(1.0*sizeof(Real)*numLocalPts(IntVect(nghost)), 0.0);
+
     Real nm0;
 
 #ifdef AMREX_USE_EB
@@ -1094,6 +1314,9 @@ MultiFab::norm1 (int comp, const Periodicity& period, bool ignore_covered ) cons
 Real
 MultiFab::norm1 (int comp, int ngrow, bool local) const
 {
+    BL_PROFILE_SITE("MultiFab::norm1()");
+    BL_PROFILE_WORK(1.0*sizeof(Real)*numLocalPts(IntVect(ngrow)), 1.0*numLocalPts(IntVect(ngrow)));
+
     Real nm1 = amrex::ReduceSum(*this, ngrow,
     [=] AMREX_GPU_HOST_DEVICE (Box const& bx, Array4<Real const> const& fab) -> Real
     {
@@ -1251,7 +1474,7 @@ MultiFab::negate (const Box& region, int comp, int num_comp, int nghost)
 void
 MultiFab::SumBoundary (int scomp, int ncomp, IntVect const& nghost, const Periodicity& period)
 {
-    BL_PROFILE("MultiFab::SumBoundary()");
+    BL_PROFILE_SITE("MultiFab::SumBoundary()");
 
     if ( n_grow == IntVect::TheZeroVector() and boxArray().ixType().cellCentered()) return;
 
@@ -1276,7 +1499,7 @@ MultiFab::SumBoundary (const Periodicity& period)
 std::unique_ptr<MultiFab>
 MultiFab::OverlapMask (const Periodicity& period) const
 {
-    BL_PROFILE("MultiFab::OverlapMask()");
+    BL_PROFILE_SITE("MultiFab::OverlapMask()");
 
     const BoxArray& ba = boxArray();
     const DistributionMapping& dm = DistributionMap();
@@ -1344,7 +1567,7 @@ MultiFab::OwnerMask (const Periodicity& period) const
 void
 MultiFab::AverageSync (const Periodicity& period)
 {
-    BL_PROFILE("MultiFab::AverageSync()");
+    BL_PROFILE_SITE("MultiFab::AverageSync()");
 
     if (ixType().cellCentered()) return;
     auto wgt = this->OverlapMask(period);
@@ -1355,7 +1578,7 @@ MultiFab::AverageSync (const Periodicity& period)
 void
 MultiFab::WeightedSync (const MultiFab& wgt, const Periodicity& period)
 {
-    BL_PROFILE("MultiFab::WeightedSync()");
+    BL_PROFILE_SITE("MultiFab::WeightedSync()");
 
     if (ixType().cellCentered()) return;
     
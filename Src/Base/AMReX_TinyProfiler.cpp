@@ -5,54 +5,392 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <cstring>
 #include <set>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include <AMReX_TinyProfiler.H>
 #include <AMReX_ParallelDescriptor.H>
 #include <AMReX_ParallelReduce.H>
 #include <AMReX_Utility.H>
 #include <AMReX_Print.H>
+#include <AMReX_ParmParse.H>
 
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstdint>
+#endif
+
 namespace amrex {
 
-std::vector<std::string>          TinyProfiler::regionstack;
-std::deque<std::tuple<double,double,std::string*> > TinyProfiler::ttstack;
-std::map<std::string,std::map<std::string, TinyProfiler::Stats> > TinyProfiler::statsmap;
+std::vector<int> TinyProfiler::regionstack;
 double TinyProfiler::t_init = std::numeric_limits<double>::max();
+bool TinyProfiler::roofline = false;
 
 namespace {
     std::set<std::string> improperly_nested_timers;
     static constexpr char mainregion[] = "main";
+
+    //! Names registered with ids. The names are never removed, so pointers to them stay valid.
+    struct NameTable
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string,int> ids;
+        std::deque<std::string> names;
+
+        int intern (const std::string& name, const std::string** p = nullptr)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = ids.find(name);
+            if (it == ids.end()) {
+                it = ids.insert(std::make_pair(name, static_cast<int>(names.size()))).first;
+                names.push_back(name);
+            }
+            if (p) *p = &names[it->second];
+            return it->second;
+        }
+
+        std::string name (int id)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return names[id];
+        }
+
+        std::vector<std::string> allNames ()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            return std::vector<std::string>(names.begin(), names.end());
+        }
+    };
+
+    NameTable& funcNames () { static NameTable t; return t; }
+    NameTable& regionNames () { static NameTable t; return t; }
+
+    bool isMasterThread () noexcept
+    {
+#ifdef _OPENMP
+        return omp_get_thread_num() == 0;
+#else
+        return true;
+#endif
+    }
+
+    struct TraceEvent
+    {
+        double t;   //!< start time
+        double dt;  //!< duration
+        int id;
+    };
+
+    //! The last events of a thread. The oldest events are overwritten when it is full.
+    struct TraceBuffer
+    {
+        std::vector<TraceEvent> events;
+        long nevents = 0;   //!< the number of events recorded
+        long nwritten = 0;  //!< the number of events written or overwritten
+        int tid = 0;
+
+        void push (const TraceEvent& e) noexcept {
+            events[nevents % events.size()] = e;
+            ++nevents;
+        }
+    };
+
+    bool trace = false;
+    int trace_buffer_size = 100000;
+    int trace_interval = 0;
+    std::string trace_file = "tiny_trace";
+
+    int current_step = 0;
+    std::vector<std::pair<int,double> > trace_steps;
+    long trace_dropped = 0;
+    bool trace_started = false;
+
+    std::mutex trace_mutex;
+    std::vector<std::unique_ptr<TraceBuffer> > trace_buffers;
+
+    TraceBuffer& traceBuffer ()
+    {
+        static thread_local TraceBuffer* tb = nullptr;
+        if (tb == nullptr) {
+            std::lock_guard<std::mutex> lock(trace_mutex);
+            trace_buffers.emplace_back(new TraceBuffer);
+            tb = trace_buffers.back().get();
+            tb->events.resize(trace_buffer_size);
+            tb->tid = trace_buffers.size()-1;
+        }
+        return *tb;
+    }
+
+    // Hardware counters, read with perf_event_open on the thread that called
+    // TinyProfiler::Initialize. They are enabled by tiny_profiler.perf_counters = 1.
+    bool perf_counters = false;
+    std::string perf_fp_event;
+    int ncounters = 0;
+    std::vector<std::string> counter_names;
+    int counter_fd = -1;  //!< the leader of the group
+    thread_local bool counter_thread = false;
+
+    //! The counts since the counters were opened, or zeros if not available on this thread.
+    void readCounters (double* cnt) noexcept
+    {
+        for (int i = 0; i < ncounters; ++i) cnt[i] = 0.0;
+#if defined(__linux__)
+        if (!counter_thread) return;
+        std::uint64_t buf[1+TinyProfiler::max_counters];
+        if (read(counter_fd, buf, sizeof(buf)) > 0 && static_cast<int>(buf[0]) == ncounters) {
+            for (int i = 0; i < ncounters; ++i) cnt[i] = static_cast<double>(buf[1+i]);
+        }
+#endif
+    }
+
+    void openCounters ()
+    {
+#if defined(__linux__)
+        struct Event { const char* name; std::uint32_t type; std::uint64_t config; };
+        Vector<Event> events{{"Cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                             {"Instr", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                             {"LLC Miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES}};
+        // There is no generic event for floating point operations, so a raw event of
+        // the CPU has to be given, e.g., FP_ARITH_INST_RETIRED on Intel.
+        if (!perf_fp_event.empty()) {
+            std::uint64_t config = 0;
+            try {
+                config = std::stoull(perf_fp_event, nullptr, 0);
+            } catch (...) {
+                amrex::Abort("TinyProfiler: invalid tiny_profiler.perf_fp_event "+perf_fp_event);
+            }
+            events.push_back(Event{"FP Ops", PERF_TYPE_RAW, config});
+        }
+        const int nevents = events.size();
+
+        auto open_event = [] (const Event& e, int group_fd) -> int
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = e.type;
+            attr.config = e.config;
+            attr.disabled = (group_fd == -1);
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+        };
+
+        // Only use the counters that all processes have.
+        Vector<int> available(nevents, 0);
+        for (int i = 0; i < nevents; ++i) {
+            int fd = open_event(events[i], -1);
+            if (fd >= 0) {
+                available[i] = 1;
+                close(fd);
+            }
+        }
+        ParallelDescriptor::ReduceIntMin(available.dataPtr(), nevents);
+
+        for (int i = 0; i < nevents; ++i) {
+            if (!available[i]) continue;
+            int fd = open_event(events[i], counter_fd);
+            if (fd < 0) continue;
+            if (counter_fd == -1) counter_fd = fd;
+            counter_names.push_back(events[i].name);
+            ++ncounters;
+        }
+
+        if (ncounters > 0) {
+            ioctl(counter_fd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(counter_fd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+            counter_thread = true;
+        }
+#endif
+        int n = ncounters;
+        ParallelDescriptor::ReduceIntMin(n);
+        if (n < ncounters) {
+            // Some process failed to open a counter that all of them have.
+            ncounters = 0;
+            counter_thread = false;
+        }
+        if (ncounters == 0) {
+            amrex::Print() << "TinyProfiler: hardware counters are not available\n";
+        }
+    }
+
+    //! Exclusive times in the main region, for tiny_profiler.timeseries_interval > 0
+    struct TimeSeriesPoint
+    {
+        int step;
+        double time;
+        double wtime;
+        std::vector<int> ids;
+        std::vector<long> n;       //!< the number of calls since the start
+        std::vector<double> dtex;  //!< the exclusive time since the start
+    };
+
+    int timeseries_interval = 0;
+    bool timeseries_per_rank = false;
+    std::string timeseries_file = "tiny_timeseries";
+    std::vector<TimeSeriesPoint> timeseries;
+
+    //! memory bandwidth per process in GB/s, for tiny_profiler.roofline = 1
+    double peak_bandwidth = 0.0;
+    bool peak_measured = false;
+    long stream_size = 1L << 23;
+
+    //! The bandwidth in GB/s of a STREAM triad on arrays of stream_size doubles
+    double streamTriad ()
+    {
+        const long n = stream_size;
+        std::unique_ptr<double[]> a(new double[n]), b(new double[n]), c(new double[n]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (long i = 0; i < n; ++i) {
+            a[i] = 0.0;
+            b[i] = 2.0;
+            c[i] = 1.0;
+        }
+        double tbest = std::numeric_limits<double>::max();
+        for (int it = 0; it < 5; ++it) {
+            double t0 = amrex::second();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+            for (long i = 0; i < n; ++i) {
+                a[i] = b[i] + 3.0*c[i];
+            }
+            tbest = std::min(tbest, amrex::second()-t0);
+        }
+        if (a[n/2] != 5.0) return 0.0;
+        return 3.0*sizeof(double)*n / tbest * 1.e-9;
+    }
+
+    std::string traceFileName ()
+    {
+        return amrex::Concatenate(trace_file+"_", ParallelDescriptor::MyProc(), 5) + ".json";
+    }
+
+    std::string jsonEscape (const std::string& str)
+    {
+        std::string r;
+        for (char c : str) {
+            if (c == '"' || c == '\\') {
+                r += '\\';
+                r += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                r += ' ';
+            } else {
+                r += c;
+            }
+        }
+        return r;
+    }
+}
+
+TinyProfiler::Site::Site (const char* funcname) noexcept
+{
+    m_id = funcNames().intern(funcname, &m_name);
+}
+
+TinyProfiler::Site::Site (const std::string& funcname, bool intern) noexcept
+{
+    if (intern) m_id = funcNames().intern(funcname, &m_name);
+}
+
+TinyProfiler::ThreadData&
+TinyProfiler::threadData () noexcept
+{
+    static thread_local ThreadData td;
+    return td;
+}
+
+const TinyProfiler::Site&
+TinyProfiler::SiteCache::get (const char* funcname) noexcept
+{
+    if (m_site.m_name == nullptr || *m_site.m_name != funcname) {
+        m_site = Site(std::string(funcname), true);
+    }
+    return m_site;
+}
+
+const TinyProfiler::Site&
+TinyProfiler::SiteCache::get (const std::string& funcname) noexcept
+{
+    if (m_site.m_name == nullptr || *m_site.m_name != funcname) {
+        m_site = Site(funcname, true);
+    }
+    return m_site;
+}
+
+bool
+TinyProfiler::recordsOnThisThread () noexcept
+{
+    return !regionstack.empty() && (trace || isMasterThread());
 }
 
 TinyProfiler::TinyProfiler (std::string funcname) noexcept
-    : fname(std::move(funcname))
+    : site(funcname, recordsOnThisThread())
 {
     start();
 }
 
 TinyProfiler::TinyProfiler (std::string funcname, bool start_) noexcept
-    : fname(std::move(funcname))
+    : site(funcname, recordsOnThisThread())
 {
     if (start_) start();
 }
 
 TinyProfiler::TinyProfiler (const char* funcname) noexcept
-    : fname(funcname)
 {
+    if (recordsOnThisThread()) site = Site(std::string(funcname), true);
     start();
 }
 
 TinyProfiler::TinyProfiler (const char* funcname, bool start_) noexcept
-    : fname(funcname)
+{
+    if (recordsOnThisThread()) site = Site(std::string(funcname), true);
+    if (start_) start();
+}
+
+TinyProfiler::TinyProfiler (const Site& a_site, const char* funcname, bool start_) noexcept
+    : site(a_site.id() >= 0 ? a_site : Site(std::string(funcname), recordsOnThisThread()))
+{
+    if (start_) start();
+}
+
+TinyProfiler::TinyProfiler (const Site& a_site, const std::string& funcname, bool start_) noexcept
+    : site(a_site.id() >= 0 ? a_site : Site(funcname, recordsOnThisThread()))
 {
     if (start_) start();
 }
 
+TinyProfiler::TinyProfiler (SiteCache& cache, const char* funcname, bool start_) noexcept
+{
+    if (recordsOnThisThread()) {
+        site = cache.get(funcname);
+        if (start_) start();
+    }
+}
+
+TinyProfiler::TinyProfiler (SiteCache& cache, const std::string& funcname, bool start_) noexcept
+{
+    if (recordsOnThisThread()) {
+        site = cache.get(funcname);
+        if (start_) start();
+    }
+}
+
 TinyProfiler::~TinyProfiler ()
 {
     stop();
@@ -61,85 +399,139 @@ TinyProfiler::~TinyProfiler ()
 void
 TinyProfiler::start () noexcept
 {
-#ifdef _OPENMP
-#pragma omp master
-#endif
-    if (stats.empty() && !regionstack.empty())
+    if (nregions > 0 || t_trace >= 0.0 || regionstack.empty() || site.m_id < 0) return;
+
+    if (isMasterThread())
     {
-	double t = amrex::second();
+        ThreadData& td = threadData();
+        const int id = site.m_id;
 
-	ttstack.emplace_back(std::make_tuple(t, 0.0, &fname));
-	global_depth = ttstack.size();
+        double t = amrex::second();
+
+        td.ttstack.push_back(Frame{t, 0.0, id, {}, {}, 0.0, 0.0});
+        global_depth = td.ttstack.size();
+        if (ncounters > 0) readCounters(td.ttstack.back().cnt);
 
 #ifdef AMREX_USE_CUDA
-	nvtx_id = nvtxRangeStartA(fname.c_str());
+        nvtx_id = nvtxRangeStartA(site.m_name->c_str());
 #endif
 
-        for (auto const& region : regionstack)
+        nregions = regionstack.size();
+        for (int region : regionstack)
         {
-            Stats& st = statsmap[region][fname];
-            ++st.depth;
-            stats.push_back(&st);
+            if (region >= static_cast<int>(td.stats.size())) td.stats.resize(region+1);
+            auto& regstats = td.stats[region];
+            if (id >= static_cast<int>(regstats.size())) regstats.resize(id+1);
+            ++regstats[id].depth;
         }
+
+        if (trace) t_trace = t;
+    }
+    else if (trace)
+    {
+        t_trace = amrex::second();
     }
 }
 
 void
 TinyProfiler::stop () noexcept
 {
-#ifdef _OPENMP
-#pragma omp master
-#endif
-    if (!stats.empty()) 
+    if (nregions == 0 && t_trace < 0.0) return;
+
+    double t = amrex::second();
+
+    if (nregions > 0 && isMasterThread())
     {
-	double t = amrex::second();
+        ThreadData& td = threadData();
+        const int id = site.m_id;
 
-	while (static_cast<int>(ttstack.size()) > global_depth) {
-	    ttstack.pop_back();
-	};
+        while (static_cast<int>(td.ttstack.size()) > global_depth) {
+            td.ttstack.pop_back();
+        };
 
-	if (static_cast<int>(ttstack.size()) == global_depth)
-	{
-	    const std::tuple<double,double,std::string*>& tt = ttstack.back();
-	    
-	    // first: wall time when the pair is pushed into the stack
-	    // second: accumulated dt of children
-	    
-	    double dtin = t - std::get<0>(tt); // elapsed time since start() is called.
-	    double dtex = dtin - std::get<1>(tt);
+        if (static_cast<int>(td.ttstack.size()) == global_depth)
+        {
+            const Frame& tt = td.ttstack.back();
+
+            double dtin = t - tt.t; // elapsed time since start() is called.
+            double dtex = dtin - tt.dtch;
 
-            for (Stats* st : stats)
+            double cntin[max_counters], cntex[max_counters];
+            if (ncounters > 0) {
+                readCounters(cntin);
+                for (int k = 0; k < ncounters; ++k) {
+                    cntin[k] -= tt.cnt[k];
+                    cntex[k] = cntin[k] - tt.cntch[k];
+                }
+            }
+
+            // The regions entered since start() are not ours.
+            const int nr = std::min(nregions, static_cast<int>(regionstack.size()));
+            for (int i = 0; i < nr; ++i)
             {
-                --(st->depth);
-                ++(st->n);
-                if (st->depth == 0) {
-                    st->dtin += dtin;
+                Stats& st = td.stats[regionstack[i]][id];
+                --st.depth;
+                ++st.n;
+                if (st.depth == 0) {
+                    st.dtin += dtin;
+                }
+                st.dtex += dtex;
+                for (int k = 0; k < ncounters; ++k) {
+                    st.cntex[k] += cntex[k];
+                }
+                st.bytes += tt.bytes;
+                st.flops += tt.flops;
+            }
+
+            td.ttstack.pop_back();
+            if (!td.ttstack.empty()) {
+                td.ttstack.back().dtch += dtin;
+                for (int k = 0; k < ncounters; ++k) {
+                    td.ttstack.back().cntch[k] += cntin[k];
                 }
-                st->dtex += dtex;
             }
-                
-	    ttstack.pop_back();
-	    if (!ttstack.empty()) {
-		std::tuple<double,double,std::string*>& parent = ttstack.back();
-		std::get<1>(parent) += dtin;
-	    }
 
 #ifdef AMREX_USE_CUDA
-	    nvtxRangeEnd(nvtx_id);
+            nvtxRangeEnd(nvtx_id);
 #endif
-	} else {
-	    improperly_nested_timers.insert(fname);
-	} 
+        } else {
+            improperly_nested_timers.insert(*site.m_name);
+        }
 
-        stats.clear();
+        nregions = 0;
+    }
+
+    if (t_trace >= 0.0)
+    {
+        traceBuffer().push(TraceEvent{t_trace, t-t_trace, site.m_id});
+        t_trace = -1.0;
     }
 }
 
 void
 TinyProfiler::Initialize () noexcept
 {
-    regionstack.push_back(mainregion);
+    regionstack.push_back(regionNames().intern(mainregion));
     t_init = amrex::second();
+
+    ParmParse pp("tiny_profiler");
+    pp.query("trace", trace);
+    pp.query("trace_buffer_size", trace_buffer_size);
+    pp.query("trace_interval", trace_interval);
+    pp.query("trace_file", trace_file);
+    trace_buffer_size = std::max(trace_buffer_size, 1);
+
+    pp.query("timeseries_interval", timeseries_interval);
+    pp.query("timeseries_per_rank", timeseries_per_rank);
+    pp.query("timeseries_file", timeseries_file);
+
+    pp.query("roofline", roofline);
+    pp.query("peak_bandwidth", peak_bandwidth);
+    pp.query("stream_size", stream_size);
+
+    pp.query("perf_counters", perf_counters);
+    pp.query("perf_fp_event", perf_fp_event);
+    if (perf_counters) openCounters();
 }
 
 void
@@ -157,7 +549,19 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
     double t_final = amrex::second();
 
     // make a local copy so that any functions call after this will not be recorded in the local copy.
-    auto lstatsmap = statsmap;
+    std::map<std::string,std::map<std::string, Stats> > lstatsmap;
+    {
+        const ThreadData& td = threadData();
+        for (int region = 0; region < static_cast<int>(td.stats.size()); ++region) {
+            auto& regstats = lstatsmap[regionNames().name(region)];
+            for (int id = 0; id < static_cast<int>(td.stats[region].size()); ++id) {
+                const Stats& st = td.stats[region][id];
+                if (st.n > 0 || st.depth > 0) {
+                    regstats[funcNames().name(id)] = st;
+                }
+            }
+        }
+    }
 
     bool properly_nested = improperly_nested_timers.size() == 0;
     ParallelDescriptor::ReduceBoolAnd(properly_nested);
@@ -220,6 +624,23 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
         }
     }
 
+    if (roofline && !peak_measured)
+    {
+        peak_measured = true;
+#ifndef AMREX_USE_GPU
+        if (peak_bandwidth <= 0.0) {
+            // All processes run the triad at the same time, as they would share the
+            // bandwidth of a node in the kernels.
+            ParallelDescriptor::Barrier();
+            peak_bandwidth = streamTriad();
+            ParallelAllReduce::Sum(peak_bandwidth, ParallelDescriptor::Communicator());
+            peak_bandwidth /= nprocs;
+            amrex::Print().SetPrecision(4) << "\nTinyProfiler STREAM triad bandwidth per process: "
+                           << peak_bandwidth << " GB/s\n";
+        }
+#endif
+    }
+
     PrintStats(lstatsmap[mainregion], dt_max);
     for (auto& kv : lstatsmap) {
         if (kv.first != mainregion) {
@@ -228,6 +649,29 @@ TinyProfiler::Finalize (bool bFlushing) noexcept
             amrex::Print() << "END REGION " << kv.first << "\n";
         }
     }
+
+    if (timeseries_interval > 0 && !bFlushing) {
+        WriteTimeSeries();
+    }
+
+    if (trace && !bFlushing)
+    {
+        WriteTrace();
+        {
+            std::ofstream ofs(traceFileName(), std::ios::app);
+            ofs << "\n]\n";
+        }
+        trace = false;
+
+        long ndropped = trace_dropped;
+        ParallelDescriptor::ReduceLongSum(ndropped, ioproc);
+        amrex::Print() << "\nTinyProfiler trace written to " << trace_file << "_*.json";
+        if (ndropped > 0) {
+            amrex::Print() << ", " << ndropped << " events were lost;"
+                           << " increase tiny_profiler.trace_buffer_size or use tiny_profiler.trace_interval";
+        }
+        amrex::Print() << "\n";
+    }
 }
 
 void
@@ -266,18 +710,25 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
     for (auto it = regstats.cbegin(); it != regstats.cend(); ++it)
     {
 	long n = it->second.n;
-	double dts[2] = {it->second.dtin, it->second.dtex};
+	const int nd = 4 + ncounters;
+	std::vector<double> dts(nd);
+	dts[0] = it->second.dtin;
+	dts[1] = it->second.dtex;
+	dts[2] = it->second.bytes;
+	dts[3] = it->second.flops;
+	for (int k = 0; k < ncounters; ++k) {
+	    dts[4+k] = it->second.cntex[k];
+	}
 
 	std::vector<long> ncalls(nprocs);
-	std::vector<double> dtdt(2*nprocs);
+	std::vector<double> dtdt(nd*nprocs);
 
 	if (ParallelDescriptor::NProcs() == 1) {
 	    ncalls[0] = n;
-	    dtdt[0] = dts[0];
-	    dtdt[1] = dts[1];
+	    dtdt = dts;
 	} else {
 	    ParallelDescriptor::Gather(&n, 1, &ncalls[0], 1, ioproc);
-	    ParallelDescriptor::Gather(dts, 2, &dtdt[0], 2, ioproc);
+	    ParallelDescriptor::Gather(dts.data(), nd, &dtdt[0], nd, ioproc);
 	}
 
 	if (ParallelDescriptor::IOProcessor()) {
@@ -286,16 +737,28 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
 		pst.nmin  = std::min(pst.nmin, ncalls[i]);
 		pst.navg +=                    ncalls[i];
 		pst.nmax  = std::max(pst.nmax, ncalls[i]);
-		pst.dtinmin  = std::min(pst.dtinmin, dtdt[2*i]);
-		pst.dtinavg +=                       dtdt[2*i];
-		pst.dtinmax  = std::max(pst.dtinmax, dtdt[2*i]);
-		pst.dtexmin  = std::min(pst.dtexmin, dtdt[2*i+1]);
-		pst.dtexavg +=                       dtdt[2*i+1];
-		pst.dtexmax  = std::max(pst.dtexmax, dtdt[2*i+1]);
+		pst.dtinmin  = std::min(pst.dtinmin, dtdt[nd*i]);
+		pst.dtinavg +=                       dtdt[nd*i];
+		pst.dtinmax  = std::max(pst.dtinmax, dtdt[nd*i]);
+		pst.dtexmin  = std::min(pst.dtexmin, dtdt[nd*i+1]);
+		pst.dtexavg +=                       dtdt[nd*i+1];
+		pst.dtexmax  = std::max(pst.dtexmax, dtdt[nd*i+1]);
+		pst.bytesavg += dtdt[nd*i+2];
+		pst.flopsavg += dtdt[nd*i+3];
+		for (int k = 0; k < ncounters; ++k) {
+		    pst.cntmin[k]  = std::min(pst.cntmin[k], dtdt[nd*i+4+k]);
+		    pst.cntavg[k] +=                         dtdt[nd*i+4+k];
+		    pst.cntmax[k]  = std::max(pst.cntmax[k], dtdt[nd*i+4+k]);
+		}
 	    }
 	    pst.navg /= nprocs;
 	    pst.dtinavg /= nprocs;
 	    pst.dtexavg /= nprocs;
+	    pst.bytesavg /= nprocs;
+	    pst.flopsavg /= nprocs;
+	    for (int k = 0; k < ncounters; ++k) {
+		pst.cntavg[k] /= nprocs;
+	    }
 	    pst.fname = it->first;
 	    
 	    allprocstats.push_back(pst);
@@ -373,22 +836,122 @@ TinyProfiler::PrintStats (std::map<std::string,Stats>& regstats, double dt_max)
 	}
 	amrex::OutStream() << hline << "\n";
 
+	// Exclusive hardware counts
+	if (ncounters > 0)
+	{
+	    const bool has_ipc = ncounters >= 2 && counter_names[0] == "Cycles"
+                                                && counter_names[1] == "Instr";
+	    int wc = 9;
+	    for (auto const& cn : counter_names) {
+		wc = std::max(wc, int(cn.size()) + 4);
+	    }
+	    const std::string chline(maxfnamelen+wnc+2+(wc+2)*3*ncounters+(has_ipc ? 7 : 0),'-');
+
+	    std::sort(allprocstats.begin(), allprocstats.end(), ProcStats::compex);
+	    amrex::OutStream() << "\n" << chline << "\n";
+	    amrex::OutStream() << std::left
+		      << std::setw(maxfnamelen) << "Name"
+		      << std::right
+		      << std::setw(wnc+2) << "NCalls";
+	    for (auto const& cn : counter_names) {
+		amrex::OutStream() << std::setw(wc+2) << cn+" Min"
+			  << std::setw(wc+2) << cn+" Avg"
+			  << std::setw(wc+2) << cn+" Max";
+	    }
+	    if (has_ipc) amrex::OutStream() << std::setw(7) << "IPC";
+	    amrex::OutStream() << "\n" << chline << "\n";
+	    for (auto it = allprocstats.cbegin(); it != allprocstats.cend(); ++it)
+	    {
+		amrex::OutStream() << std::setprecision(4) << std::left
+			  << std::setw(maxfnamelen) << it->fname
+			  << std::right
+			  << std::setw(wnc+2) << it->navg;
+		for (int k = 0; k < ncounters; ++k) {
+		    amrex::OutStream() << std::setw(wc+2) << it->cntmin[k]
+			      << std::setw(wc+2) << it->cntavg[k]
+			      << std::setw(wc+2) << it->cntmax[k];
+		}
+		if (has_ipc) {
+		    amrex::OutStream() << std::setprecision(2) << std::setw(7) << std::fixed
+			      << ((it->cntavg[0] > 0.0) ? it->cntavg[1]/it->cntavg[0] : 0.0);
+		    amrex::OutStream().unsetf(std::ios_base::fixed);
+		}
+		amrex::OutStream() << "\n";
+	    }
+	    amrex::OutStream() << chline << "\n";
+	}
+
+	if (roofline) PrintRoofline(allprocstats, maxfnamelen);
+
 	amrex::OutStream() << std::endl;
     }
 }
 
+void
+TinyProfiler::PrintRoofline (const std::vector<ProcStats>& allprocstats, int maxfnamelen)
+{
+    std::vector<const ProcStats*> work;
+    for (auto const& pst : allprocstats) {
+        if (pst.bytesavg > 0.0 || pst.flopsavg > 0.0) work.push_back(&pst);
+    }
+    if (work.empty()) return;
+
+    std::sort(work.begin(), work.end(), [] (const ProcStats* lhs, const ProcStats* rhs)
+                                        { return lhs->dtexavg > rhs->dtexavg; });
+
+    const int wt = 10;
+    const bool has_peak = peak_bandwidth > 0.0;
+    const std::string hline(maxfnamelen+(wt+2)*(has_peak ? 5 : 4),'-');
+
+    // Average bytes and flops of a process over its average exclusive time
+    amrex::OutStream() << "\n" << hline << "\n";
+    amrex::OutStream() << std::left
+              << std::setw(maxfnamelen) << "Name"
+              << std::right
+              << std::setw(wt+2) << "Excl. Avg"
+              << std::setw(wt+2) << "GB/s"
+              << std::setw(wt+2) << "GFLOP/s"
+              << std::setw(wt+2) << "Flop/Byte";
+    if (has_peak) amrex::OutStream() << std::setw(wt+2) << "Peak BW %";
+    amrex::OutStream() << "\n" << hline << "\n";
+    for (const ProcStats* p : work)
+    {
+        const double gbs = (p->dtexavg > 0.0) ? p->bytesavg/p->dtexavg*1.e-9 : 0.0;
+        const double gflops = (p->dtexavg > 0.0) ? p->flopsavg/p->dtexavg*1.e-9 : 0.0;
+        amrex::OutStream() << std::setprecision(4) << std::left
+                  << std::setw(maxfnamelen) << p->fname
+                  << std::right
+                  << std::setw(wt+2) << p->dtexavg
+                  << std::setw(wt+2) << gbs
+                  << std::setw(wt+2) << gflops
+                  << std::setw(wt+2) << ((p->bytesavg > 0.0) ? p->flopsavg/p->bytesavg : 0.0);
+        if (has_peak) {
+            amrex::OutStream() << std::setprecision(2) << std::setw(wt+1) << std::fixed
+                      << gbs*(100.0/peak_bandwidth) << "%";
+            amrex::OutStream().unsetf(std::ios_base::fixed);
+        }
+        amrex::OutStream() << "\n";
+    }
+    amrex::OutStream() << hline << "\n";
+    if (!has_peak) {
+        amrex::OutStream() << "Set tiny_profiler.peak_bandwidth in GB/s per process"
+                           << " to compare with the peak bandwidth\n";
+    }
+}
+
 void
 TinyProfiler::StartRegion (std::string regname) noexcept
 {
-    if (std::find(regionstack.begin(), regionstack.end(), regname) == regionstack.end()) {
-        regionstack.emplace_back(std::move(regname));
+    const int region = regionNames().intern(regname);
+    if (std::find(regionstack.begin(), regionstack.end(), region) == regionstack.end()) {
+        regionstack.push_back(region);
     }
 }
 
 void
 TinyProfiler::StopRegion (const std::string& regname) noexcept
 {
-    if (regname == regionstack.back()) {
+    if (!regionstack.empty() && regionNames().intern(regname) == regionstack.back()) {
         regionstack.pop_back();
     }
 }
@@ -415,12 +978,248 @@ TinyProfileRegion::~TinyProfileRegion ()
     TinyProfiler::StopRegion(regname);
 }
 
+void
+TinyProfiler::AddStep (int step) noexcept
+{
+    current_step = step;
+    if (trace) trace_steps.emplace_back(step, amrex::second());
+}
+
+void
+TinyProfiler::FlushTrace ()
+{
+    if (trace && trace_interval > 0 && current_step % trace_interval == 0) {
+        WriteTrace();
+    }
+}
+
+void
+TinyProfiler::WriteTrace ()
+{
+    if (!trace) return;
+
+    BL_PROFILE("TinyProfiler::WriteTrace()");
+
+    const int rank = ParallelDescriptor::MyProc();
+    const std::vector<std::string> names = funcNames().allNames();
+
+    std::ofstream ofs(traceFileName(), trace_started ? std::ios::app : std::ios::trunc);
+    ofs << std::fixed << std::setprecision(3);
+
+    auto ts = [] (double t) { return (t - t_init) * 1.e6; };
+
+    if (!trace_started) {
+        ofs << "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank
+            << ",\"args\":{\"name\":\"rank " << rank << "\"}}";
+        ofs << ",\n{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":" << rank
+            << ",\"args\":{\"sort_index\":" << rank << "}}";
+        trace_started = true;
+    }
+
+    for (auto const& step : trace_steps) {
+        ofs << ",\n{\"name\":\"STEP " << step.first << "\",\"ph\":\"i\",\"s\":\"p\",\"ts\":"
+            << ts(step.second) << ",\"pid\":" << rank << ",\"tid\":0}";
+    }
+    trace_steps.clear();
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    for (auto& tb : trace_buffers)
+    {
+        const long nbuf = tb->events.size();
+        if (tb->nwritten == 0 && tb->nevents > 0) {
+            ofs << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << rank
+                << ",\"tid\":" << tb->tid << ",\"args\":{\"name\":\"thread " << tb->tid << "\"}}";
+        }
+        const long first = std::max(tb->nwritten, tb->nevents - nbuf);
+        trace_dropped += first - tb->nwritten;
+        for (long i = first; i < tb->nevents; ++i)
+        {
+            const TraceEvent& e = tb->events[i % nbuf];
+            ofs << ",\n{\"name\":\"" << jsonEscape(names[e.id])
+                << "\",\"ph\":\"X\",\"ts\":" << ts(e.t) << ",\"dur\":" << e.dt*1.e6
+                << ",\"pid\":" << rank << ",\"tid\":" << tb->tid << "}";
+        }
+        tb->nwritten = tb->nevents;
+    }
+}
+
+void
+TinyProfiler::AddWork (double bytes, double flops) noexcept
+{
+    if (isMasterThread())
+    {
+        ThreadData& td = threadData();
+        if (!td.ttstack.empty()) {
+            td.ttstack.back().bytes += bytes;
+            td.ttstack.back().flops += flops;
+        }
+    }
+}
+
+void
+TinyProfiler::RecordTimeSeries (int step, double time)
+{
+    if (timeseries_interval <= 0 || step % timeseries_interval != 0) return;
+
+    TimeSeriesPoint p;
+    p.step = step;
+    p.time = time;
+    p.wtime = amrex::second() - t_init;
+
+    const ThreadData& td = threadData();
+    const int region = regionstack.empty() ? 0 : regionstack.front();
+    if (region < static_cast<int>(td.stats.size())) {
+        const auto& regstats = td.stats[region];
+        for (int id = 0; id < static_cast<int>(regstats.size()); ++id) {
+            if (regstats[id].n > 0) {
+                p.ids.push_back(id);
+                p.n.push_back(regstats[id].n);
+                p.dtex.push_back(regstats[id].dtex);
+            }
+        }
+    }
+
+    timeseries.push_back(std::move(p));
+}
+
+void
+TinyProfiler::WriteTimeSeries ()
+{
+    BL_PROFILE("TinyProfiler::WriteTimeSeries()");
+
+    const int npoints = timeseries.size();
+    const std::vector<std::string> names = funcNames().allNames();
+
+    if (timeseries_per_rank)
+    {
+        std::ofstream ofs(amrex::Concatenate(timeseries_file+"_", ParallelDescriptor::MyProc(), 5)
+                          + ".csv");
+        ofs << std::setprecision(6);
+        ofs << "step,time,wtime,name,ncalls,excl\n";
+        std::vector<long> n0(names.size(), 0L);
+        std::vector<double> dt0(names.size(), 0.0);
+        for (auto const& p : timeseries) {
+            for (int i = 0; i < static_cast<int>(p.ids.size()); ++i) {
+                const int id = p.ids[i];
+                if (p.n[i] > n0[id]) {
+                    ofs << p.step << ',' << p.time << ',' << p.wtime << ",\"" << names[id] << "\","
+                        << p.n[i]-n0[id] << ',' << p.dtex[i]-dt0[id] << '\n';
+                }
+                n0[id] = p.n[i];
+                dt0[id] = p.dtex[i];
+            }
+        }
+        return;
+    }
+
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    const MPI_Comm comm = ParallelDescriptor::Communicator();
+
+    int npmin = npoints, npmax = npoints;
+    ParallelDescriptor::ReduceIntMin(npmin);
+    ParallelDescriptor::ReduceIntMax(npmax);
+    if (npmin != npmax) {
+        amrex::Print() << "TinyProfiler: RecordTimeSeries was not called on all processes;"
+                       << " the time series is not written\n";
+        return;
+    }
+
+    // Put the functions of all processes in the same order.
+    Vector<std::string> local_names, synced_names;
+    {
+        std::vector<bool> used(names.size(), false);
+        for (auto const& p : timeseries) {
+            for (int id : p.ids) used[id] = true;
+        }
+        for (int id = 0; id < static_cast<int>(names.size()); ++id) {
+            if (used[id]) local_names.push_back(names[id]);
+        }
+    }
+    // The union may contain duplicates and, if the sets already match, it is in
+    // the local order, so we sort it to get the same columns on all processes.
+    std::sort(local_names.begin(), local_names.end());
+    bool synced;
+    amrex::SyncStrings(local_names, synced_names, synced);
+    std::sort(synced_names.begin(), synced_names.end());
+    synced_names.erase(std::unique(synced_names.begin(), synced_names.end()),
+                       synced_names.end());
+    const int nnames = synced_names.size();
+
+    std::vector<int> id_to_col(names.size(), -1);
+    {
+        std::map<std::string,int> col;
+        for (int i = 0; i < nnames; ++i) col[synced_names[i]] = i;
+        for (int id = 0; id < static_cast<int>(names.size()); ++id) {
+            auto it = col.find(names[id]);
+            if (it != col.end()) id_to_col[id] = it->second;
+        }
+    }
+
+    // The exclusive time of each function between two points
+    std::vector<double> dtmin(npoints*nnames, 0.0);
+    {
+        std::vector<double> dt0(nnames, 0.0);
+        for (int ip = 0; ip < npoints; ++ip) {
+            auto const& p = timeseries[ip];
+            for (int i = 0; i < static_cast<int>(p.ids.size()); ++i) {
+                const int c = id_to_col[p.ids[i]];
+                dtmin[ip*nnames+c] = p.dtex[i] - dt0[c];
+                dt0[c] = p.dtex[i];
+            }
+        }
+    }
+    std::vector<double> dtmax = dtmin, dtavg = dtmin;
+
+    ParallelReduce::Min(dtmin.data(), dtmin.size(), ioproc, comm);
+    ParallelReduce::Max(dtmax.data(), dtmax.size(), ioproc, comm);
+    ParallelReduce::Sum(dtavg.data(), dtavg.size(), ioproc, comm);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        const double nprocs = ParallelDescriptor::NProcs();
+        std::ofstream ofs(timeseries_file + ".csv");
+        ofs << std::setprecision(6);
+        ofs << "step,time,wtime,name,excl_min,excl_avg,excl_max\n";
+        for (int ip = 0; ip < npoints; ++ip) {
+            auto const& p = timeseries[ip];
+            for (int c = 0; c < nnames; ++c) {
+                const int i = ip*nnames+c;
+                if (dtmax[i] > 0.0) {
+                    ofs << p.step << ',' << p.time << ',' << p.wtime << ",\"" << synced_names[c] << "\","
+                        << dtmin[i] << ',' << dtavg[i]/nprocs << ',' << dtmax[i] << '\n';
+                }
+            }
+        }
+    }
+}
+
+void
+TinyProfiler::TraceComm (const Site& a_site, bool begin) noexcept
+{
+    if (!trace) return;
+
+    static thread_local double t_begin = -1.0;
+    if (begin) {
+        t_begin = amrex::second();
+    } else if (t_begin >= 0.0) {
+        traceBuffer().push(TraceEvent{t_begin, amrex::second()-t_begin, a_site.id()});
+        t_begin = -1.0;
+    }
+}
+
+std::string
+TinyProfiler::CommName (const std::string& cft)
+{
+    const auto pos = cft.rfind(':');
+    return "MPI_" + ((pos == std::string::npos) ? cft : cft.substr(pos+1));
+}
+
 void
 TinyProfiler::PrintCallStack (std::ostream& os)
 {
     os << "===== TinyProfilers ======\n";
-    for (auto const& x : ttstack) {
-        os << *(std::get<2>(x)) << "\n";
+    for (auto const& x : threadData().ttstack) {
+        os << funcNames().name(x.id) << "\n";
     }
 }
 
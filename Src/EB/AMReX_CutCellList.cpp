@@ -0,0 +1,210 @@
+
+#include <AMReX_CutCellList.H>
+#include <AMReX_EB2_Level.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Scan.H>
+
+namespace amrex {
+
+namespace {
+
+    // Copy ncomp components of the cell data in mf, shifted by shift, into the
+    // components starting at dcomp of the lists of the boxes in sub_to_full.
+    void gatherMoments (LayoutData<CutCellList>& lists, const Vector<int>& sub_to_full,
+                        const MultiFab& mf, int dcomp, IntVect const& shift)
+    {
+        const int ncomp = mf.nComp();
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+        {
+            CutCellList& list = lists[sub_to_full[mfi.index()]];
+            const int n = list.size();
+            IntVect const* cells = list.cells().dataPtr();
+            Real* data = list.data().dataPtr();
+            auto const& a = mf.const_array(mfi);
+            amrex::ParallelFor(n, [=] AMREX_GPU_DEVICE (int i) noexcept
+            {
+                const IntVect iv = cells[i] + shift;
+                for (int icomp = 0; icomp < ncomp; ++icomp) {
+                    data[(dcomp+icomp)*n+i] = a(iv,icomp);
+                }
+            });
+        }
+        Gpu::synchronize();
+    }
+
+    void findCutCells (const EBCellFlagFab& flagfab, CutCellList& list)
+    {
+        const Box& bx = flagfab.box();
+        auto const& flag = flagfab.const_array();
+        const auto lo = amrex::lbound(bx);
+        const auto len = amrex::length(bx);
+        const int npts = bx.numPts();
+
+        auto index = [=] AMREX_GPU_HOST_DEVICE (int icell) noexcept -> IntVect
+        {
+            int k =  icell /   (len.x*len.y);
+            int j = (icell - k*(len.x*len.y)) /   len.x;
+            int i = (icell - k*(len.x*len.y)) - j*len.x;
+            return IntVect{AMREX_D_DECL(i+lo.x, j+lo.y, k+lo.z)};
+        };
+
+#ifdef AMREX_USE_GPU
+        if (Gpu::inLaunchRegion())
+        {
+            auto is_cut = [=] AMREX_GPU_DEVICE (int icell) noexcept -> int
+            {
+                return flag(index(icell)).isSingleValued();
+            };
+            const int n = Scan::PrefixSum<int>(npts, is_cut,
+                                               [=] AMREX_GPU_DEVICE (int, int const&) {},
+                                               Scan::Type::exclusive);
+            list.cells().resize(n);
+            IntVect* cells = list.cells().dataPtr();
+            Scan::PrefixSum<int>(npts, is_cut,
+                                 [=] AMREX_GPU_DEVICE (int icell, int const& s)
+                                 {
+                                     if (is_cut(icell)) cells[s] = index(icell);
+                                 },
+                                 Scan::Type::exclusive);
+            return;
+        }
+#endif
+        Vector<IntVect> cells;
+        for (int icell = 0; icell < npts; ++icell) {
+            const IntVect iv = index(icell);
+            if (flag(iv).isSingleValued()) cells.push_back(iv);
+        }
+        list.cells().resize(cells.size());
+        Gpu::copy(Gpu::hostToDevice, cells.begin(), cells.end(), list.cells().begin());
+    }
+}
+
+MultiCutCellList::MultiCutCellList (const EB2::Level& a_level, const Geometry& a_geom,
+                                    const BoxArray& a_ba, const DistributionMapping& a_dm,
+                                    int a_ngrow)
+{
+    define(a_level, a_geom, a_ba, a_dm, a_ngrow);
+}
+
+MultiCutCellList::MultiCutCellList (const EBFArrayBoxFactory& a_factory, int a_ngrow)
+{
+    AMREX_ALWAYS_ASSERT(a_factory.getEBLevel() != nullptr);
+    define(*a_factory.getEBLevel(), a_factory.Geom(),
+           a_factory.boxArray(), a_factory.DistributionMap(), a_ngrow);
+}
+
+void
+MultiCutCellList::define (const EB2::Level& a_level, const Geometry& a_geom,
+                          const BoxArray& a_ba_in, const DistributionMapping& a_dm,
+                          int a_ngrow)
+{
+    BL_PROFILE("MultiCutCellList::define()");
+
+    const BoxArray& a_ba = amrex::convert(a_ba_in, IntVect::TheZeroVector());
+    m_data.define(a_ba, a_dm);
+    m_ngrow = a_ngrow;
+
+    Vector<int> is_cut(a_ba.size(), 0);
+    {
+        FabArray<EBCellFlagFab> cellflags(a_ba, a_dm, 1, a_ngrow);
+        a_level.fillEBCellFlag(cellflags, a_geom);
+
+        for (MFIter mfi(cellflags); mfi.isValid(); ++mfi)
+        {
+            if (cellflags[mfi].getType() == FabType::singlevalued) {
+                findCutCells(cellflags[mfi], m_data[mfi]);
+                m_data[mfi].data().resize(m_data[mfi].size()*CutCellView::ncomp);
+                is_cut[mfi.index()] = 1;
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceIntMax(is_cut.dataPtr(), is_cut.size());
+
+    // The dense moments are filled one after the other on the boxes with cut cells
+    // only, so at any time at most a few components of those boxes are allocated.
+    Vector<int> sub_to_full;
+    BoxList sub_bl(a_ba.ixType());
+    Vector<int> sub_pmap;
+    for (int i = 0; i < a_ba.size(); ++i) {
+        if (is_cut[i]) {
+            sub_to_full.push_back(i);
+            sub_bl.push_back(a_ba[i]);
+            sub_pmap.push_back(a_dm[i]);
+        }
+    }
+    if (sub_to_full.empty()) return;
+
+    const BoxArray sub_ba(std::move(sub_bl));
+    const DistributionMapping sub_dm(std::move(sub_pmap));
+    const int ng = a_ngrow;
+
+    {
+        MultiFab mf(sub_ba, sub_dm, 1, ng);
+        a_level.fillVolFrac(mf, a_geom);
+        gatherMoments(m_data, sub_to_full, mf, CutCellView::volfrac_comp, IntVect::TheZeroVector());
+    }
+    {
+        MultiFab mf(sub_ba, sub_dm, AMREX_SPACEDIM, ng);
+        a_level.fillCentroid(mf, a_geom);
+        gatherMoments(m_data, sub_to_full, mf, CutCellView::centroid_comp, IntVect::TheZeroVector());
+        a_level.fillBndryCent(mf, a_geom);
+        gatherMoments(m_data, sub_to_full, mf, CutCellView::bndrycent_comp, IntVect::TheZeroVector());
+        a_level.fillBndryNorm(mf, a_geom);
+        gatherMoments(m_data, sub_to_full, mf, CutCellView::bndrynorm_comp, IntVect::TheZeroVector());
+    }
+    {
+        MultiFab mf(sub_ba, sub_dm, 1, ng);
+        a_level.fillBndryArea(mf, a_geom);
+        gatherMoments(m_data, sub_to_full, mf, CutCellView::bndryarea_comp, IntVect::TheZeroVector());
+    }
+
+    for (int ifc = 0; ifc < 2; ++ifc)
+    {
+        // Area fractions first, then face centroids
+        const int ncomp = (ifc == 0) ? 1 : AMREX_SPACEDIM-1;
+        const int dcomp = (ifc == 0) ? CutCellView::areafrac_comp : CutCellView::facecent_comp;
+        Array<MultiFab,AMREX_SPACEDIM> mf;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            mf[idim].define(amrex::convert(sub_ba, IntVect::TheDimensionVector(idim)),
+                            sub_dm, ncomp, ng);
+        }
+        if (ifc == 0) {
+            a_level.fillAreaFrac(amrex::GetArrOfPtrs(mf), a_geom);
+        } else {
+            a_level.fillFaceCent(amrex::GetArrOfPtrs(mf), a_geom);
+        }
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            for (int side = 0; side < 2; ++side) {
+                gatherMoments(m_data, sub_to_full, mf[idim], dcomp+(2*idim+side)*ncomp,
+                              IntVect::TheDimensionVector(idim)*side);
+            }
+        }
+    }
+}
+
+long
+MultiCutCellList::numCutCells () const noexcept
+{
+    long r = 0;
+    for (int i = 0; i < m_data.local_size(); ++i) {
+        r += m_data[m_data.IndexArray()[i]].size();
+    }
+    return r;
+}
+
+long
+MultiCutCellList::nbytes () const noexcept
+{
+    long r = 0;
+    for (int i = 0; i < m_data.local_size(); ++i) {
+        r += m_data[m_data.IndexArray()[i]].nbytes();
+    }
+    return r;
+}
+
+}
@@ -7,22 +7,29 @@
 #include <AMReX_EB2_IF_Sphere.H>
 #include <AMReX_EB2_IF_Torus.H>
 #include <AMReX_EB2_IF_Spline.H>
+#include <AMReX_EB2_IF_STL.H>
 #include <AMReX_EB2_GeometryShop.H>
 #include <AMReX_EB2.H>
 #include <AMReX_ParmParse.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_Utility.H>
 #include <AMReX.H>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
 Vector<std::unique_ptr<IndexSpace> > IndexSpace::m_instance;
 
 int max_grid_size = 64;
+bool lazy_coarsening = false;
 
 void Initialize ()
 {
     ParmParse pp("eb2");
     pp.query("max_grid_size", max_grid_size);
+    pp.query("lazy_coarsening", lazy_coarsening);
 
     amrex::ExecOnFinalize(Finalize);
 }
@@ -71,6 +78,30 @@ Build (const Geometry& geom, int required_coarsening_level,
     std::string geom_type;
     pp.get("geom_type", geom_type);
 
+    std::string chkpt_file;
+    pp.query("chkpt_file", chkpt_file);
+    std::uint64_t hash = 0;
+    if (!chkpt_file.empty())
+    {
+        // The geometry is described by eb2.geom_type and the eb2.<geom_type>_*
+        // parameters.  Other eb2.* parameters, e.g., eb2.lazy_coarsening, are left
+        // out, so that changing them does not invalidate the checkpoint.
+        const std::string prefix = "eb2." + geom_type + "_";
+        std::ostringstream table;
+        ParmParse::dumpTable(table);
+        std::istringstream iss(table.str());
+        std::string key = "geom_type " + geom_type + '\n';
+        std::string line;
+        while (std::getline(iss, line)) {
+            if (line.compare(0, prefix.size(), prefix) == 0) {
+                key += line + '\n';
+            }
+        }
+        hash = GeometryHash(geom, required_coarsening_level, max_coarsening_level,
+                            ngrow, build_coarse_level_by_coarsening, key);
+        if (BuildFromChkptFile(chkpt_file, geom, hash)) return;
+    }
+
     if (geom_type == "all_regular")
     {
         EB2::AllRegularIF rif;
@@ -170,10 +201,174 @@ Build (const Geometry& geom, int required_coarsening_level,
         EB2::Build(gshop, geom, required_coarsening_level,
                    max_coarsening_level, ngrow, build_coarse_level_by_coarsening);
     }
+#if (AMREX_SPACEDIM == 3)
+    else if (geom_type == "stl")
+    {
+        std::string stl_file;
+        pp.get("stl_file", stl_file);
+
+        Real scale = 1.0;
+        pp.query("stl_scale", scale);
+
+        RealArray center{0.0, 0.0, 0.0};
+        pp.query("stl_center", center);
+
+        bool has_fluid_inside = false;
+        pp.query("stl_has_fluid_inside", has_fluid_inside);
+
+        EB2::STLIF sf(stl_file, scale, center, has_fluid_inside);
+
+        EB2::GeometryShop<EB2::STLIF> gshop(sf);
+        EB2::Build(gshop, geom, required_coarsening_level,
+                   max_coarsening_level, ngrow, build_coarse_level_by_coarsening);
+    }
+#endif
     else
     {
         amrex::Abort("geom_type "+geom_type+ " not supported");
     }
+
+    if (!chkpt_file.empty()) {
+        WriteChkptFile(chkpt_file, geom, hash);
+    }
+}
+
+IndexSpaceChkptFile::IndexSpaceChkptFile (const std::string& dirname, const Geometry& geom)
+{
+    Vector<char> buf;
+    ParallelDescriptor::ReadAndBcastFile(dirname+"/Header", buf);
+    std::istringstream iss(buf.dataPtr());
+
+    std::string version;
+    std::uint64_t hash;
+    int nlevels = 0;
+    iss >> version >> hash >> nlevels;
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(iss && nlevels > 0,
+                                     "EB2::IndexSpaceChkptFile: cannot read "+dirname);
+
+    m_chkptlevel.reserve(nlevels);
+    Geometry g = geom;
+    for (int ilev = 0; ilev < nlevels; ++ilev)
+    {
+        if (ilev > 0) g = amrex::coarsen(g,2);
+        m_chkptlevel.emplace_back(this, g, amrex::LevelFullPath(ilev, dirname));
+        m_geom.push_back(g);
+        m_domain.push_back(g.Domain());
+    }
+}
+
+const Level&
+IndexSpaceChkptFile::getLevel (const Geometry& geom) const
+{
+    auto it = std::find(std::begin(m_domain), std::end(m_domain), geom.Domain());
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(it != std::end(m_domain),
+                                     "EB2::IndexSpace::getLevel: no EB level for this domain");
+    int i = std::distance(m_domain.begin(), it);
+    return m_chkptlevel[i];
+}
+
+const Geometry&
+IndexSpaceChkptFile::getGeometry (const Box& dom) const
+{
+    auto it = std::find(std::begin(m_domain), std::end(m_domain), dom);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(it != std::end(m_domain),
+                                     "EB2::IndexSpace::getGeometry: no EB level for this domain");
+    int i = std::distance(m_domain.begin(), it);
+    return m_geom[i];
+}
+
+std::uint64_t
+GeometryHash (const Geometry& geom, int required_coarsening_level, int max_coarsening_level,
+              int ngrow, bool build_coarse_level_by_coarsening, const std::string& key)
+{
+    Real small_volfrac = 1.e-14;
+    {
+        ParmParse pp("eb2");
+        pp.query("small_volfrac", small_volfrac);
+    }
+
+    std::ostringstream oss;
+    oss.precision(17);
+    oss << geom.Domain() << ' ' << geom.ProbDomain() << ' ' << geom.CoordInt();
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        oss << ' ' << geom.isPeriodic(idim);
+    }
+    oss << ' ' << required_coarsening_level << ' ' << max_coarsening_level
+        << ' ' << ngrow << ' ' << build_coarse_level_by_coarsening
+        << ' ' << EB2::max_grid_size << ' ' << small_volfrac << '\n' << key;
+
+    // 64-bit FNV-1a
+    std::uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : oss.str()) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void
+WriteChkptFile (const std::string& dirname, const Geometry& geom, std::uint64_t hash)
+{
+    BL_PROFILE("EB2::WriteChkptFile()");
+
+    const IndexSpace& ebis = IndexSpace::top();
+
+    // Build the levels left out by eb2.lazy_coarsening, since the IndexSpace read
+    // back cannot build them.
+    ebis.coarsenTo(Box(IntVect::TheZeroVector(), IntVect::TheZeroVector()));
+
+    Vector<const Level*> levels;
+    Box dom = geom.Domain();
+    while (true) {
+        levels.push_back(&ebis.getLevel(ebis.getGeometry(dom)));
+        if (dom == ebis.coarsestDomain()) break;
+        dom.coarsen(2);
+    }
+
+    const int nlevels = levels.size();
+    amrex::PreBuildDirectorHierarchy(dirname, "Level_", nlevels, true);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::string hname = dirname + "/Header";
+        std::ofstream ofs(hname.c_str());
+        if (!ofs.good()) amrex::FileOpenFailed(hname);
+        ofs << "EB2ChkptFile-V1\n" << hash << '\n' << nlevels << '\n';
+    }
+
+    for (int ilev = 0; ilev < nlevels; ++ilev) {
+        levels[ilev]->writeToChkptFile(amrex::LevelFullPath(ilev, dirname));
+    }
+
+    ParallelDescriptor::Barrier();
+}
+
+bool
+BuildFromChkptFile (const std::string& dirname, const Geometry& geom, std::uint64_t hash)
+{
+    BL_PROFILE("EB2::BuildFromChkptFile()");
+
+    const std::string hname = dirname + "/Header";
+    int exists = ParallelDescriptor::IOProcessor() ? amrex::FileExists(hname) : 0;
+    ParallelDescriptor::Bcast(&exists, 1, ParallelDescriptor::IOProcessorNumber());
+    if (!exists) return false;
+
+    Vector<char> buf;
+    ParallelDescriptor::ReadAndBcastFile(hname, buf);
+    std::istringstream iss(buf.dataPtr());
+    std::string version;
+    std::uint64_t file_hash = 0;
+    iss >> version >> file_hash;
+    if (!iss || version != "EB2ChkptFile-V1" || file_hash != hash) {
+        if (amrex::Verbose()) {
+            amrex::Print() << "EB2: " << dirname << " holds a different geometry, "
+                           << "which will be built again\n";
+        }
+        return false;
+    }
+
+    IndexSpace::push(new IndexSpaceChkptFile(dirname, geom));
+    return true;
 }
 
 namespace {
@@ -205,4 +400,15 @@ maxCoarseningLevel (IndexSpace const* ebis, const Geometry& geom)
     return comp_max_crse_level(cdomain,domain);
 }
 
+int
+maxCoarseningLevel (IndexSpace const* ebis, const Geometry& geom, int max_level)
+{
+    Box domain = amrex::enclosedCells(geom.Domain());
+    for (int ilev = 0; ilev < max_level && domain.coarsenable(2,2); ++ilev) {
+        domain.coarsen(2);
+    }
+    ebis->coarsenTo(domain);
+    return std::min(max_level, maxCoarseningLevel(ebis, geom));
+}
+
 }}
@@ -0,0 +1,454 @@
+#include <AMReX_EB2_IF_STL.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_BLProfiler.H>
+#include <AMReX.H>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace amrex { namespace EB2 {
+
+#if (AMREX_SPACEDIM == 3)
+
+namespace {
+
+    constexpr int bvh_leaf_size = 4;
+    constexpr int bvh_max_depth = 64;
+
+    inline Real dot3 (const Real* a, const Real* b) noexcept
+    {
+        return a[0]*b[0] + a[1]*b[1] + a[2]*b[2];
+    }
+
+    inline void sub3 (const Real* a, const Real* b, Real* c) noexcept
+    {
+        c[0] = a[0]-b[0];
+        c[1] = a[1]-b[1];
+        c[2] = a[2]-b[2];
+    }
+
+    inline void cross3 (const Real* a, const Real* b, Real* c) noexcept
+    {
+        c[0] = a[1]*b[2] - a[2]*b[1];
+        c[1] = a[2]*b[0] - a[0]*b[2];
+        c[2] = a[0]*b[1] - a[1]*b[0];
+    }
+
+    // Squared distance from p to triangle t, following Ericson, Real-Time Collision
+    // Detection, section 5.1.5.
+    Real point_triangle_dist2 (const Real* p, const Real* t) noexcept
+    {
+        const Real* a = t;
+        const Real* b = t+3;
+        const Real* c = t+6;
+        Real ab[3], ac[3], ap[3], q[3];
+        sub3(b, a, ab);
+        sub3(c, a, ac);
+        sub3(p, a, ap);
+
+        auto dist2 = [&] (const Real* x) -> Real {
+            Real d[3];
+            sub3(p, x, d);
+            return dot3(d,d);
+        };
+
+        const Real d1 = dot3(ab, ap);
+        const Real d2 = dot3(ac, ap);
+        if (d1 <= 0.0 && d2 <= 0.0) return dist2(a);
+
+        Real bp[3];
+        sub3(p, b, bp);
+        const Real d3 = dot3(ab, bp);
+        const Real d4 = dot3(ac, bp);
+        if (d3 >= 0.0 && d4 <= d3) return dist2(b);
+
+        const Real vc = d1*d4 - d3*d2;
+        if (vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0) {
+            const Real v = d1 / (d1 - d3);
+            for (int i = 0; i < 3; ++i) q[i] = a[i] + v*ab[i];
+            return dist2(q);
+        }
+
+        Real cp[3];
+        sub3(p, c, cp);
+        const Real d5 = dot3(ab, cp);
+        const Real d6 = dot3(ac, cp);
+        if (d6 >= 0.0 && d5 <= d6) return dist2(c);
+
+        const Real vb = d5*d2 - d1*d6;
+        if (vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0) {
+            const Real w = d2 / (d2 - d6);
+            for (int i = 0; i < 3; ++i) q[i] = a[i] + w*ac[i];
+            return dist2(q);
+        }
+
+        const Real va = d3*d6 - d5*d4;
+        if (va <= 0.0 && (d4-d3) >= 0.0 && (d5-d6) >= 0.0) {
+            const Real w = (d4-d3) / ((d4-d3) + (d5-d6));
+            for (int i = 0; i < 3; ++i) q[i] = b[i] + w*(c[i]-b[i]);
+            return dist2(q);
+        }
+
+        const Real denom = 1.0 / (va + vb + vc);
+        const Real v = vb * denom;
+        const Real w = vc * denom;
+        for (int i = 0; i < 3; ++i) q[i] = a[i] + ab[i]*v + ac[i]*w;
+        return dist2(q);
+    }
+
+    // Does the ray o + s*d, s > 0, cross triangle t? (Moller and Trumbore)
+    bool ray_hits_triangle (const Real* o, const Real* d, const Real* t) noexcept
+    {
+        Real e1[3], e2[3], pv[3], tv[3], qv[3];
+        sub3(t+3, t, e1);
+        sub3(t+6, t, e2);
+        cross3(d, e2, pv);
+        const Real det = dot3(e1, pv);
+        if (det == 0.0) return false;
+        const Real inv_det = 1.0/det;
+        sub3(o, t, tv);
+        const Real u = dot3(tv, pv) * inv_det;
+        if (u < 0.0 || u > 1.0) return false;
+        cross3(tv, e1, qv);
+        const Real v = dot3(d, qv) * inv_det;
+        if (v < 0.0 || u + v > 1.0) return false;
+        return dot3(e2, qv) * inv_det > 0.0;
+    }
+}
+
+class STLIF::Impl
+{
+public:
+
+    explicit Impl (Vector<Real>&& triangles);
+
+    Real distance2 (const Real* p) const noexcept;
+    bool isInside (const Real* p) const noexcept;
+
+    int numTriangles () const noexcept { return m_ntri; }
+    const Real* lo () const noexcept { return m_nodes[0].lo; }
+    const Real* hi () const noexcept { return m_nodes[0].hi; }
+
+private:
+
+    struct Node
+    {
+        Real lo[3];
+        Real hi[3];
+        int first;  // the first triangle of a leaf
+        int count;  // the number of triangles of a leaf, 0 for interior nodes
+        int right;  // the right child of an interior node; the left child is next to it
+    };
+
+    int build (Vector<int>& idx, const Vector<Real>& centroid, int begin, int end);
+
+    Real boxDistance2 (const Node& node, const Real* p) const noexcept;
+    int countCrossings (const Real* o, const Real* d) const noexcept;
+
+    int m_ntri;
+    Vector<Real> m_tri;
+    Vector<Node> m_nodes;
+};
+
+STLIF::Impl::Impl (Vector<Real>&& triangles)
+    : m_ntri(triangles.size()/9)
+{
+    BL_PROFILE("STLIF::BuildBVH");
+
+    if (m_ntri == 0) amrex::Abort("EB2::STLIF: no triangles");
+
+    Vector<Real> centroid(3*m_ntri);
+    for (int n = 0; n < m_ntri; ++n) {
+        for (int i = 0; i < 3; ++i) {
+            centroid[3*n+i] = (triangles[9*n+i] + triangles[9*n+3+i] + triangles[9*n+6+i]) / 3.0;
+        }
+    }
+
+    Vector<int> idx(m_ntri);
+    for (int n = 0; n < m_ntri; ++n) idx[n] = n;
+
+    m_tri = std::move(triangles);
+    m_nodes.reserve(2*(m_ntri/bvh_leaf_size+1));
+    build(idx, centroid, 0, m_ntri);
+
+    // Store the triangles in the order of the leaves.
+    Vector<Real> sorted(m_tri.size());
+    for (int n = 0; n < m_ntri; ++n) {
+        std::copy(m_tri.begin()+9*idx[n], m_tri.begin()+9*idx[n]+9, sorted.begin()+9*n);
+    }
+    std::swap(m_tri, sorted);
+}
+
+int
+STLIF::Impl::build (Vector<int>& idx, const Vector<Real>& centroid, int begin, int end)
+{
+    const int inode = m_nodes.size();
+    m_nodes.push_back(Node());
+
+    Node node;
+    Real clo[3], chi[3];
+    for (int i = 0; i < 3; ++i) {
+        node.lo[i] = clo[i] = std::numeric_limits<Real>::max();
+        node.hi[i] = chi[i] = std::numeric_limits<Real>::lowest();
+    }
+    for (int n = begin; n < end; ++n) {
+        const int t = idx[n];
+        for (int v = 0; v < 3; ++v) {
+            for (int i = 0; i < 3; ++i) {
+                node.lo[i] = std::min(node.lo[i], m_tri[9*t+3*v+i]);
+                node.hi[i] = std::max(node.hi[i], m_tri[9*t+3*v+i]);
+            }
+        }
+        for (int i = 0; i < 3; ++i) {
+            clo[i] = std::min(clo[i], centroid[3*t+i]);
+            chi[i] = std::max(chi[i], centroid[3*t+i]);
+        }
+    }
+
+    node.first = begin;
+    node.count = end - begin;
+    node.right = -1;
+
+    if (end - begin > bvh_leaf_size)
+    {
+        int dir = 0;
+        for (int i = 1; i < 3; ++i) {
+            if (chi[i]-clo[i] > chi[dir]-clo[dir]) dir = i;
+        }
+        const int mid = (begin + end) / 2;
+        std::nth_element(idx.begin()+begin, idx.begin()+mid, idx.begin()+end,
+                         [&] (int a, int b) { return centroid[3*a+dir] < centroid[3*b+dir]; });
+        node.count = 0;
+        build(idx, centroid, begin, mid);
+        node.right = build(idx, centroid, mid, end);
+    }
+
+    m_nodes[inode] = node;
+    return inode;
+}
+
+Real
+STLIF::Impl::boxDistance2 (const Node& node, const Real* p) const noexcept
+{
+    Real d2 = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        const Real d = std::max({node.lo[i]-p[i], Real(0.0), p[i]-node.hi[i]});
+        d2 += d*d;
+    }
+    return d2;
+}
+
+Real
+STLIF::Impl::distance2 (const Real* p) const noexcept
+{
+    Real best = std::numeric_limits<Real>::max();
+    int stack[bvh_max_depth];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const Node& node = m_nodes[stack[--top]];
+        if (boxDistance2(node, p) >= best) continue;
+        if (node.count > 0) {
+            for (int n = node.first; n < node.first+node.count; ++n) {
+                best = std::min(best, point_triangle_dist2(p, &m_tri[9*n]));
+            }
+        } else {
+            // Visit the nearer child first, so that it is more likely to prune the other.
+            const int left = &node - m_nodes.data() + 1;
+            const int right = node.right;
+            if (boxDistance2(m_nodes[left], p) < boxDistance2(m_nodes[right], p)) {
+                stack[top++] = right;
+                stack[top++] = left;
+            } else {
+                stack[top++] = left;
+                stack[top++] = right;
+            }
+        }
+    }
+    return best;
+}
+
+int
+STLIF::Impl::countCrossings (const Real* o, const Real* d) const noexcept
+{
+    Real dinv[3];
+    for (int i = 0; i < 3; ++i) dinv[i] = 1.0/d[i];
+
+    int ncross = 0;
+    int stack[bvh_max_depth];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0)
+    {
+        const int inode = stack[--top];
+        const Node& node = m_nodes[inode];
+
+        Real tmin = 0.0;
+        Real tmax = std::numeric_limits<Real>::max();
+        for (int i = 0; i < 3; ++i) {
+            Real t0 = (node.lo[i]-o[i])*dinv[i];
+            Real t1 = (node.hi[i]-o[i])*dinv[i];
+            if (t0 > t1) std::swap(t0, t1);
+            tmin = std::max(tmin, t0);
+            tmax = std::min(tmax, t1);
+        }
+        if (tmin > tmax) continue;
+
+        if (node.count > 0) {
+            for (int n = node.first; n < node.first+node.count; ++n) {
+                if (ray_hits_triangle(o, d, &m_tri[9*n])) ++ncross;
+            }
+        } else {
+            stack[top++] = inode+1;
+            stack[top++] = node.right;
+        }
+    }
+    return ncross;
+}
+
+bool
+STLIF::Impl::isInside (const Real* p) const noexcept
+{
+    for (int i = 0; i < 3; ++i) {
+        if (p[i] < lo()[i] || p[i] > hi()[i]) return false;
+    }
+
+    // Directions that are unlikely to be parallel to the faces of CAD geometries.
+    static constexpr Real dirs[3][3] = {{ 0.8017, 0.4581, 0.3841},
+                                        {-0.3371, 0.8892,-0.3095},
+                                        {-0.2719,-0.3598, 0.8925}};
+    int votes = 0;
+    for (int r = 0; r < 3; ++r) {
+        if (countCrossings(p, dirs[r]) % 2 == 1) ++votes;
+        if (votes == 2 || votes + (2-r) < 2) break;
+    }
+    return votes >= 2;
+}
+
+namespace {
+
+    Vector<Real> readSTL (const std::string& filename, Real scale, const RealArray& center)
+    {
+        BL_PROFILE("STLIF::readSTL");
+
+        Vector<char> buf;
+        ParallelDescriptor::ReadAndBcastFile(filename, buf);
+        const std::size_t len = buf.size() - 1;  // ReadAndBcastFile appends a null
+
+        Vector<Real> tri;
+
+        std::uint32_t nbinary = 0;
+        if (len >= 84) std::memcpy(&nbinary, buf.data()+80, sizeof(nbinary));
+        if (len >= 84 && len == 84 + 50*static_cast<std::size_t>(nbinary))
+        {
+            // Binary: a normal and three vertices as 32-bit floats, and 2 attribute bytes.
+            tri.resize(9*static_cast<std::size_t>(nbinary));
+            for (std::size_t n = 0; n < nbinary; ++n) {
+                const char* rec = buf.data() + 84 + 50*n + 12;
+                for (int k = 0; k < 9; ++k) {
+                    float x;
+                    std::memcpy(&x, rec+4*k, sizeof(float));
+                    tri[9*n+k] = x;
+                }
+            }
+        }
+        else
+        {
+            std::istringstream is(std::string(buf.data(), len));
+            std::string word;
+            while (is >> word) {
+                if (word == "vertex") {
+                    Real x, y, z;
+                    is >> x >> y >> z;
+                    tri.push_back(x);
+                    tri.push_back(y);
+                    tri.push_back(z);
+                }
+            }
+            if (tri.size() % 9 != 0) {
+                amrex::Abort("EB2::STLIF: "+filename+" is not a valid STL file");
+            }
+        }
+
+        for (Long n = 0; n < tri.size(); ++n) {
+            tri[n] = tri[n]*scale + center[n%3];
+        }
+
+        return tri;
+    }
+}
+
+STLIF::STLIF (const std::string& a_filename, Real a_scale, const RealArray& a_center, bool a_inside)
+    : m_impl(std::make_shared<Impl>(readSTL(a_filename, a_scale, a_center))),
+      m_sign(a_inside ? 1.0 : -1.0)
+{}
+
+STLIF::STLIF (const Vector<Real>& a_triangles, bool a_inside)
+    : m_impl(std::make_shared<Impl>(Vector<Real>(a_triangles))),
+      m_sign(a_inside ? 1.0 : -1.0)
+{}
+
+Real
+STLIF::operator() (const RealArray& p) const noexcept
+{
+    const Real d = distance(p);
+    return isInside(p) ? -m_sign*d : m_sign*d;
+}
+
+IFBounds
+STLIF::bounds (const RealArray& lo, const RealArray& hi) const noexcept
+{
+    // The signed distance changes by at most the distance moved, so the box is on one
+    // side of the surface if its center is farther from the surface than its corners.
+    RealArray c;
+    Real h2 = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        c[i] = 0.5*(lo[i]+hi[i]);
+        h2 += 0.25*(hi[i]-lo[i])*(hi[i]-lo[i]);
+    }
+    const Real h = std::sqrt(h2);
+    const Real d = distance(c);
+    if (d <= h) {
+        return IFBounds{-(d+h), d+h};
+    } else if (isInside(c) == (m_sign > 0.0)) {
+        return IFBounds{-(d+h), -(d-h)};
+    } else {
+        return IFBounds{d-h, d+h};
+    }
+}
+
+int
+STLIF::numTriangles () const noexcept
+{
+    return m_impl->numTriangles();
+}
+
+void
+STLIF::boundingBox (RealArray& lo, RealArray& hi) const noexcept
+{
+    for (int i = 0; i < 3; ++i) {
+        lo[i] = m_impl->lo()[i];
+        hi[i] = m_impl->hi()[i];
+    }
+}
+
+Real
+STLIF::distance (const RealArray& p) const noexcept
+{
+    return std::sqrt(m_impl->distance2(p.data()));
+}
+
+bool
+STLIF::isInside (const RealArray& p) const noexcept
+{
+    return m_impl->isInside(p.data());
+}
+
+#endif
+
+}}
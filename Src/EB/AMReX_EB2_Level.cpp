@@ -1,7 +1,10 @@
 
 #include <AMReX_EB2_Level.H>
 #include <AMReX_IArrayBox.H>
+#include <AMReX_VisMF.H>
 #include <algorithm>
+#include <fstream>
+#include <sstream>
 
 namespace amrex { namespace EB2 {
 
@@ -845,4 +848,130 @@ Level::fillLevelSet (MultiFab& levelset, const Geometry& geom) const
     }
 }
         
+void
+Level::writeToChkptFile (const std::string& dirname) const
+{
+    BL_PROFILE("EB2::Level::writeToChkptFile()");
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::string hname = dirname + "/Header";
+        std::ofstream ofs(hname.c_str());
+        if (!ofs.good()) amrex::FileOpenFailed(hname);
+        ofs << m_geom.Domain() << '\n'
+            << m_ngrow << '\n'
+            << static_cast<int>(m_allregular) << '\n'
+            << m_covered_grids.size() << '\n';
+        if (!m_covered_grids.empty()) {
+            m_covered_grids.writeOn(ofs);
+            ofs << '\n';
+        }
+    }
+
+    if (m_allregular) return;
+
+    // EBCellFlag is a 32-bit integer, which a Real holds exactly.
+    MultiFab cellflag(m_grids, m_dmap, 1, m_cellflag.nGrow());
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(cellflag); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.fabbox();
+        auto const& dst = cellflag.array(mfi);
+        auto const& src = m_cellflag.const_array(mfi);
+        AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bx, i, j, k,
+        {
+            dst(i,j,k) = static_cast<Real>(src(i,j,k).getValue());
+        });
+    }
+
+    VisMF::Write(cellflag, dirname+"/cellflag");
+    VisMF::Write(m_levelset, dirname+"/levelset");
+    VisMF::Write(m_volfrac, dirname+"/volfrac");
+    VisMF::Write(m_centroid, dirname+"/centroid");
+    VisMF::Write(m_bndryarea, dirname+"/bndryarea");
+    VisMF::Write(m_bndrycent, dirname+"/bndrycent");
+    VisMF::Write(m_bndrynorm, dirname+"/bndrynorm");
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        VisMF::Write(m_areafrac[idim], dirname+"/areafrac_"+std::to_string(idim));
+        VisMF::Write(m_facecent[idim], dirname+"/facecent_"+std::to_string(idim));
+    }
+}
+
+namespace {
+    // The MultiFabs are written with different numbers of ghost cells (e.g., the level
+    // set has GFab::ng), so mf is defined with the index type, number of components and
+    // ghost cells found in the VisMF header, on the cell-centered grids and dmap.
+    void readChkptMultiFab (MultiFab& mf, const BoxArray& grids, const DistributionMapping& dmap,
+                            const std::string& name)
+    {
+        VisMF vismf(name);
+        mf.define(amrex::convert(grids, vismf.boxArray().ixType()), dmap,
+                  vismf.nComp(), vismf.nGrowVect());
+        VisMF::Read(mf, name);
+    }
+}
+
+ChkptFileLevel::ChkptFileLevel (IndexSpace const* is, const Geometry& geom,
+                                const std::string& dirname)
+    : Level(is, geom)
+{
+    BL_PROFILE("EB2::ChkptFileLevel()");
+
+    Vector<char> buf;
+    ParallelDescriptor::ReadAndBcastFile(dirname+"/Header", buf);
+    std::istringstream iss(buf.dataPtr());
+
+    Box domain;
+    int allregular;
+    long ncovered;
+    iss >> domain >> m_ngrow >> allregular >> ncovered;
+    if (ncovered > 0) {
+        m_covered_grids.readFrom(iss);
+    }
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(iss && domain == geom.Domain(),
+                                     "EB2::ChkptFileLevel: "+dirname+" does not match the geometry");
+    m_allregular = allregular;
+
+    if (!m_allregular)
+    {
+        MultiFab cellflag;
+        VisMF::Read(cellflag, dirname+"/cellflag");
+        m_grids = cellflag.boxArray();
+        m_dmap = cellflag.DistributionMap();
+
+        const int ng = cellflag.nGrow();
+        m_cellflag.define(m_grids, m_dmap, 1, ng);
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(cellflag); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.fabbox();
+            auto const& dst = m_cellflag.array(mfi);
+            auto const& src = cellflag.const_array(mfi);
+            AMREX_HOST_DEVICE_PARALLEL_FOR_3D(bx, i, j, k,
+            {
+                dst(i,j,k) = EBCellFlag(static_cast<uint32_t>(src(i,j,k)));
+            });
+        }
+
+        readChkptMultiFab(m_levelset, m_grids, m_dmap, dirname+"/levelset");
+        readChkptMultiFab(m_volfrac, m_grids, m_dmap, dirname+"/volfrac");
+        readChkptMultiFab(m_centroid, m_grids, m_dmap, dirname+"/centroid");
+        readChkptMultiFab(m_bndryarea, m_grids, m_dmap, dirname+"/bndryarea");
+        readChkptMultiFab(m_bndrycent, m_grids, m_dmap, dirname+"/bndrycent");
+        readChkptMultiFab(m_bndrynorm, m_grids, m_dmap, dirname+"/bndrynorm");
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            readChkptMultiFab(m_areafrac[idim], m_grids, m_dmap,
+                              dirname+"/areafrac_"+std::to_string(idim));
+            readChkptMultiFab(m_facecent[idim], m_grids, m_dmap,
+                              dirname+"/facecent_"+std::to_string(idim));
+        }
+    }
+
+    m_ok = true;
+}
+
 }}
@@ -94,6 +94,14 @@ EBFArrayBoxFactory::maxCoarseningLevel () const noexcept
     }
 }
 
+int
+EBFArrayBoxFactory::maxCoarseningLevel (int max_level) const
+{
+    EB2::IndexSpace const* ebis = (m_parent) ? m_parent->getEBIndexSpace()
+                                             : &EB2::IndexSpace::top();
+    return EB2::maxCoarseningLevel(ebis, m_geom, max_level);
+}
+
 const DistributionMapping&
 EBFArrayBoxFactory::DistributionMap () const noexcept
 {
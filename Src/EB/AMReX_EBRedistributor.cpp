@@ -0,0 +1,257 @@
+
+#include <AMReX_EBRedistributor.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_EBMultiFabUtil.H>
+#include <AMReX_MultiFab.H>
+
+namespace amrex {
+
+#if (AMREX_SPACEDIM > 1)
+
+namespace {
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    IntVect nbr_offset (int inbr) noexcept
+    {
+        return IntVect{AMREX_D_DECL(inbr%3-1, (inbr/3)%3-1, inbr/9-1)};
+    }
+}
+
+EBRedistributor::EBRedistributor (const EBFArrayBoxFactory& a_factory, const Geometry& a_geom)
+{
+    define(a_factory, a_geom);
+}
+
+void
+EBRedistributor::define (const EBFArrayBoxFactory& a_factory, const Geometry& a_geom)
+{
+    BL_PROFILE("EBRedistributor::define()");
+
+    const Real tolerance = std::numeric_limits<Real>::epsilon();
+    const Real* dx = a_geom.CellSize();
+    for (int idim = 1; idim < AMREX_SPACEDIM; ++idim) {
+        if (std::abs(dx[0] - dx[idim]) > tolerance)
+            amrex::Abort("EBRedistributor: grid spacing must be uniform");
+    }
+
+    m_geom = a_geom;
+    m_lists.define(a_factory.boxArray(), a_factory.DistributionMap());
+
+    const auto& flags   = a_factory.getMultiEBCellFlagFab();
+    const auto& volfrac = a_factory.getVolFrac();
+    AMREX_ALWAYS_ASSERT(flags.nGrow() >= 2 && volfrac.nGrow() >= 2);
+
+    const Box dbox = a_geom.growPeriodicDomain(2);
+
+    // The lists are built on the host, once per geometry.
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(m_lists); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        const EBCellFlagFab& flagfab = flags[mfi];
+        BoxLists& lists = m_lists[mfi];
+
+        if (flagfab.getType(bx) == FabType::covered ||
+            flagfab.getType(amrex::grow(bx,2)) == FabType::regular) continue;
+
+        auto const& flag  = flagfab.const_array();
+        auto const& vfrac = volfrac.const_array(mfi);
+        auto mask = [&] (const IntVect& iv) -> Real { return dbox.contains(iv) ? 1.0 : 0.0; };
+
+        Vector<IntVect> src_cell;
+        Vector<Real> src_vfrac, src_mask;
+        Vector<Array<Real,nnbr>> src_nbr;
+        BaseFab<int> src_index(amrex::grow(bx,1));
+        src_index.setVal<RunOn::Host>(-1);
+        auto const& isrc = src_index.array();
+
+        const Box& grown1_bx = amrex::grow(bx,1);
+        amrex::LoopOnCpu(grown1_bx, [&] (int i, int j, int k) noexcept
+        {
+            const IntVect iv(AMREX_D_DECL(i,j,k));
+            if (!flag(iv).isSingleValued()) return;
+            Array<Real,nnbr> w;
+            for (int inbr = 0; inbr < nnbr; ++inbr) {
+                const IntVect off = nbr_offset(inbr);
+                const IntVect nb = iv + off;
+                w[inbr] = (off != IntVect::TheZeroVector() && flag(iv).isConnected(off)
+                           && dbox.contains(nb)) ? vfrac(nb) * mask(nb) : 0.0;
+            }
+            isrc(iv) = src_cell.size();
+            src_cell.push_back(iv);
+            src_vfrac.push_back(vfrac(iv));
+            src_mask.push_back(mask(iv));
+            src_nbr.push_back(w);
+        });
+
+        const int nsrc = src_cell.size();
+        if (nsrc == 0) continue;
+
+        // Invert the connections: for every cell of the box, the cut cells that
+        // redistribute into it.
+        Vector<IntVect> dst_cell;
+        Vector<int> dst_self, dst_offset(1,0), dst_src;
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+        {
+            const IntVect iv(AMREX_D_DECL(i,j,k));
+            const int nsrc_before = dst_src.size();
+            for (int inbr = 0; inbr < nnbr; ++inbr) {
+                const IntVect off = nbr_offset(inbr);
+                const IntVect nb = iv - off;
+                if (off == IntVect::TheZeroVector() || !grown1_bx.contains(nb)) continue;
+                const int m = isrc(nb);
+                if (m >= 0 && flag(nb).isConnected(off)) dst_src.push_back(m);
+            }
+            if (isrc(iv) >= 0 || static_cast<int>(dst_src.size()) > nsrc_before) {
+                dst_cell.push_back(iv);
+                dst_self.push_back(isrc(iv));
+                dst_offset.push_back(dst_src.size());
+            }
+        });
+
+        Vector<Real> nbr(nsrc*nnbr);
+        for (int m = 0; m < nsrc; ++m) {
+            for (int inbr = 0; inbr < nnbr; ++inbr) {
+                nbr[inbr*nsrc+m] = src_nbr[m][inbr];
+            }
+        }
+
+        auto copy_to_device = [] (auto const& v, auto& dv)
+        {
+            dv.resize(v.size());
+            Gpu::copy(Gpu::hostToDevice, v.begin(), v.end(), dv.begin());
+        };
+        copy_to_device(src_cell, lists.src_cell);
+        copy_to_device(src_vfrac, lists.src_vfrac);
+        copy_to_device(src_mask, lists.src_mask);
+        copy_to_device(nbr, lists.src_nbr);
+        copy_to_device(dst_cell, lists.dst_cell);
+        copy_to_device(dst_self, lists.dst_self);
+        copy_to_device(dst_offset, lists.dst_offset);
+        copy_to_device(dst_src, lists.dst_src);
+        lists.optmp.resize(nsrc);
+        lists.delm.resize(nsrc);
+    }
+}
+
+void
+EBRedistributor::apply (MultiFab& div_tmp_in, MultiFab& div_out, const MultiFab& weights,
+                        int div_comp, int ncomp) const
+{
+    BL_PROFILE("EBRedistributor::apply()");
+
+    AMREX_ASSERT(div_tmp_in.nGrow() >= 2 && weights.nGrow() >= 2);
+    AMREX_ASSERT(div_out.boxArray() == m_lists.boxArray() &&
+                 div_out.DistributionMap() == m_lists.DistributionMap());
+
+    Real covered_val = 1.e40;
+    EB_set_covered(div_tmp_in, 0, ncomp, div_tmp_in.nGrow(), covered_val);
+    div_tmp_in.FillBoundary(m_geom.periodicity());
+
+    // Here we take care of both the regular and covered cases ... all we do below is the cut cell cases
+    MultiFab::Copy(div_out, div_tmp_in, 0, div_comp, ncomp, 0);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(div_out); mfi.isValid(); ++mfi)
+    {
+        const BoxLists& lists = m_lists[mfi];
+        const int nsrc = lists.src_cell.size();
+        const int ndst = lists.dst_cell.size();
+        if (nsrc == 0) continue;
+
+        auto const& div  = div_out.array(mfi);
+        auto const& divc = div_tmp_in.const_array(mfi);
+        auto const& wt   = weights.const_array(mfi);
+
+        IntVect const* src_cell  = lists.src_cell.dataPtr();
+        Real const*    src_vfrac = lists.src_vfrac.dataPtr();
+        Real const*    src_mask  = lists.src_mask.dataPtr();
+        Real const*    src_nbr   = lists.src_nbr.dataPtr();
+        IntVect const* dst_cell  = lists.dst_cell.dataPtr();
+        int const* dst_self   = lists.dst_self.dataPtr();
+        int const* dst_offset = lists.dst_offset.dataPtr();
+        int const* dst_src    = lists.dst_src.dataPtr();
+
+        // For every cut cell, its own update and the weighted mass that
+        // it redistributes to its neighbors
+        if (static_cast<int>(lists.optmp.size()) < nsrc*ncomp) {
+            // Kernels of an earlier call may still use the old buffers.
+            Gpu::Device::streamSynchronize();
+            lists.optmp.resize(nsrc*ncomp);
+            lists.delm.resize(nsrc*ncomp);
+        }
+        Real* optmp = lists.optmp.dataPtr();
+        Real* delm  = lists.delm.dataPtr();
+
+        amrex::ParallelFor(nsrc, [=] AMREX_GPU_DEVICE (int m) noexcept
+        {
+            const IntVect iv = src_cell[m];
+            const Real vfrac = src_vfrac[m];
+
+            Real vtot = 0.0;
+            for (int inbr = 0; inbr < nnbr; ++inbr) {
+                const Real g = src_nbr[inbr*nsrc+m];
+                if (g != 0.0) vtot += g * wt(iv + nbr_offset(inbr));
+            }
+            const Real vtot_inv = 1.0 / (vtot + 1.e-80);
+
+            for (int n = 0; n < ncomp; ++n)
+            {
+                Real divnc = 0.0;
+                for (int inbr = 0; inbr < nnbr; ++inbr) {
+                    const Real g = src_nbr[inbr*nsrc+m];
+                    if (g != 0.0) {
+                        const IntVect nb = iv + nbr_offset(inbr);
+                        divnc += g * wt(nb) * divc(nb,n);
+                    }
+                }
+                divnc *= vtot_inv;
+
+                const Real op = (1 - vfrac) * (divnc - divc(iv,n) * src_mask[m]);
+                optmp[n*nsrc+m] = op;
+                delm [n*nsrc+m] = -vfrac * op * vtot_inv;
+            }
+        });
+
+        amrex::ParallelFor(ndst, [=] AMREX_GPU_DEVICE (int d) noexcept
+        {
+            const IntVect iv = dst_cell[d];
+            const int self = dst_self[d];
+            const Real w = wt(iv);
+            for (int n = 0; n < ncomp; ++n)
+            {
+                Real r = (self >= 0) ? optmp[n*nsrc+self] : 0.0;
+                for (int s = dst_offset[d]; s < dst_offset[d+1]; ++s) {
+                    r += delm[n*nsrc+dst_src[s]] * w;
+                }
+                div(iv,div_comp+n) = divc(iv,n) + r;
+            }
+        });
+    }
+}
+
+void
+EBRedistributor::apply (MultiFab& div_tmp_in, MultiFab& div_out, int div_comp, int ncomp) const
+{
+    MultiFab weights(div_out.boxArray(), div_out.DistributionMap(), 1, div_tmp_in.nGrow());
+    weights.setVal(1.0);
+
+    apply(div_tmp_in, div_out, weights, div_comp, ncomp);
+}
+
+long
+EBRedistributor::numCutCells () const noexcept
+{
+    long r = 0;
+    for (int i = 0; i < m_lists.local_size(); ++i) {
+        r += m_lists[m_lists.IndexArray()[i]].src_cell.size();
+    }
+    return r;
+}
+
+#endif
+
+}
@@ -730,6 +730,293 @@ void LSFactory::fill_data (MultiFab & data, iMultiFab & valid,
 
 
 
+namespace {
+
+    // Godunov update of the eikonal equation |grad u| = 1 at a node, given the
+    // smallest neighboring value a[d] in each direction and the spacing h[d].
+    Real eikonal_update (Real a[], Real h[]) {
+
+        // Sort the directions by increasing neighbor value
+        for (int i = 1; i < AMREX_SPACEDIM; ++i) {
+            for (int j = i; j > 0 && a[j] < a[j-1]; --j) {
+                std::swap(a[j], a[j-1]);
+                std::swap(h[j], h[j-1]);
+            }
+        }
+
+        Real u = a[0] + h[0];
+        Real A = 0, B = 0, C = -1;
+        for (int m = 0; m < AMREX_SPACEDIM; ++m) {
+            if (u <= a[m]) break;
+            // Solve sum_{d<=m} ((u - a[d])/h[d])^2 = 1
+            A += 1/(h[m]*h[m]);
+            B += a[m]/(h[m]*h[m]);
+            C += a[m]*a[m]/(h[m]*h[m]);
+            u = (B + std::sqrt(std::max(B*B - A*C, Real(0)))) / A;
+        }
+        return u;
+    }
+
+    // Gauss-Seidel sweeps in all 2^AMREX_SPACEDIM orderings over the nodes of
+    // `bx` with `free_nd == 1`. Returns whether any value has changed.
+    bool fast_sweep (const Box & bx, Array4<Real> const & phi, Array4<int const> const & free_nd,
+                     const Box & fab_box, const RealVect & dx, Real threshold) {
+
+        const auto lo = amrex::lbound(bx);
+        const auto hi = amrex::ubound(bx);
+        const auto flo = amrex::lbound(fab_box);
+        const auto fhi = amrex::ubound(fab_box);
+        bool changed = false;
+
+        for (int sweep = 0; sweep < (1 << AMREX_SPACEDIM); ++sweep) {
+            const int si = (sweep & 1) ? -1 : 1;
+            const int sj = (sweep & 2) ? -1 : 1;
+            const int sk = (sweep & 4) ? -1 : 1;
+            for (int kk = 0; kk <= hi.z-lo.z; ++kk) {
+            for (int jj = 0; jj <= hi.y-lo.y; ++jj) {
+            for (int ii = 0; ii <= hi.x-lo.x; ++ii) {
+                const int i = (si > 0) ? lo.x+ii : hi.x-ii;
+                const int j = (sj > 0) ? lo.y+jj : hi.y-jj;
+                const int k = (sk > 0) ? lo.z+kk : hi.z-kk;
+                if (free_nd(i,j,k) != 1) continue;
+
+                Real a[AMREX_SPACEDIM], h[AMREX_SPACEDIM];
+                const int ijk[3] = {i, j, k};
+                const int flo3[3] = {flo.x, flo.y, flo.z};
+                const int fhi3[3] = {fhi.x, fhi.y, fhi.z};
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    int lo_n[3] = {i, j, k};
+                    int hi_n[3] = {i, j, k};
+                    lo_n[d] -= 1;
+                    hi_n[d] += 1;
+                    a[d] = threshold;
+                    if (ijk[d] > flo3[d]) {
+                        a[d] = std::min(a[d], std::abs(phi(lo_n[0], lo_n[1], lo_n[2])));
+                    }
+                    if (ijk[d] < fhi3[d]) {
+                        a[d] = std::min(a[d], std::abs(phi(hi_n[0], hi_n[1], hi_n[2])));
+                    }
+                    h[d] = dx[d];
+                }
+
+                const Real u_old = std::abs(phi(i,j,k));
+                const Real u_new = std::min(eikonal_update(a, h), threshold);
+                if (u_new < u_old) {
+                    phi(i,j,k) = std::copysign(u_new, phi(i,j,k));
+                    changed = true;
+                }
+            }
+            }
+            }
+        }
+
+        return changed;
+    }
+}
+
+
+
+int LSFactory::update_data (MultiFab & data, iMultiFab & valid,
+                            const EBFArrayBoxFactory & eb_factory,
+                            const MultiFab & eb_impfunc,
+                            const IntVect & ebt_size, int ls_ref, int eb_ref,
+                            const Geometry & geom, const Geometry & geom_eb,
+                            const Box & update_box, int band) {
+
+    BL_PROFILE("LSFactory::update_data()")
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(band >= 1, "LSFactory::update_data: band must be >= 1");
+
+    RealVect dx(AMREX_D_DECL(geom.CellSize(0),
+                             geom.CellSize(1),
+                             geom.CellSize(2)));
+
+    RealVect dx_eb(AMREX_D_DECL(geom_eb.CellSize(0),
+                                geom_eb.CellSize(1),
+                                geom_eb.CellSize(2)));
+
+    const int ls_pad = data.nGrow();
+
+    const BoxArray & ls_ba            = data.boxArray();
+    const BoxArray & eb_ba            = eb_factory.boxArray();
+    const DistributionMapping & ls_dm = data.DistributionMap();
+
+    const MultiCutFab & bndrycent = eb_factory.getBndryCent();
+    const auto & flags = eb_factory.getMultiEBCellFlagFab();
+    const int eb_pad = flags.nGrow();
+
+    MultiFab normal(eb_ba, ls_dm, 3, eb_pad); //deliberately use levelset DM
+    amrex::FillEBNormals(normal, eb_factory, geom_eb);
+
+    iMultiFab eb_valid(ls_ba, ls_dm, 1, ls_pad);
+    eb_valid.setVal(0);
+
+    // Nodes to be filled by fast sweeping
+    iMultiFab free_nd(ls_ba, ls_dm, 1, ls_pad);
+    free_nd.setVal(0);
+
+    const Real min_dx = LSUtility::min_dx(geom_eb);
+    const Real ls_threshold = min_dx * (eb_pad+1);
+
+    // The level-set changes wherever the old or the new EB is closer than the
+    // threshold
+    Box active_box = update_box;
+    active_box.grow(static_cast<int>(std::ceil(ls_threshold/LSUtility::min_dx(geom))) + 1);
+
+    // Beyond `reach` nodes from the EB, the level-set is at the threshold
+    const int reach = static_cast<int>(std::ceil(ls_threshold/LSUtility::min_dx(geom))) + 1;
+
+
+    /****************************************************************************
+     *                                                                          *
+     * Loop over EB tile boxes (ebt) as in fill_data. Only the nodes within     *
+     * `active_box` are touched, and only those close to the EB are computed   *
+     * from the EB facets.                                                      *
+     *                                                                          *
+     ***************************************************************************/
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(data, ebt_size * std::max(1, ls_ref/eb_ref)); mfi.isValid(); ++mfi)
+    {
+        const Box tile_box = mfi.growntilebox() & active_box;
+        if (! tile_box.ok()) continue;
+
+        const auto & if_tile = eb_impfunc[mfi];
+        auto & v_tile        = eb_valid[mfi];
+        auto & ls_tile       = data[mfi];
+        auto & region_tile   = valid[mfi];
+
+        std::unique_ptr<Vector<Real>> facets;
+        if (bndrycent.ok(mfi)) {
+            Box eb_search = mfi.tilebox();
+            eb_search.coarsen(ls_ref);
+            eb_search.refine(eb_ref);
+            eb_search.enclosedCells();
+            eb_search.grow(eb_pad);
+
+            facets = eb_facets(normal[mfi], bndrycent[mfi], flags[mfi], dx_eb, eb_search);
+        }
+        int len_facets = facets ? facets->size() : 0;
+
+        if (len_facets > 0) {
+
+            //___________________________________________________________________
+            // Narrow band: nodes within `band` nodes of a sign change of the
+            // implicit function. Only these get their distance from the facets.
+            // The nodes up to `reach` nodes away are left to fast sweeping, and
+            // all others are set to the threshold. Sign changes beyond the
+            // ghost nodes of `eb_impfunc` are not seen, so the nodes close to
+            // its edge are always left to fast sweeping.
+            const auto impf = if_tile.const_array();
+            const Box ext_box = amrex::grow(tile_box, reach) & if_tile.box();
+            const Box inner_box = amrex::grow(if_tile.box(), -reach);
+            BaseFab<int> dist(ext_box, 1);
+            BaseFab<int> dist_tmp(ext_box, 1);
+            auto const & dd = dist.array();
+            auto const & dt = dist_tmp.array();
+
+            amrex::LoopOnCpu(ext_box, [&] (int i, int j, int k) noexcept
+            {
+                const IntVect iv(AMREX_D_DECL(i,j,k));
+                const bool inside = impf(iv) > 0;
+                bool change = false;
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    for (int side = -1; side <= 1; side += 2) {
+                        const IntVect nb = iv + side*IntVect::TheDimensionVector(d);
+                        if (ext_box.contains(nb) && (impf(nb) > 0) != inside) change = true;
+                    }
+                }
+                dd(iv) = change ? 0 : reach+1;
+            });
+
+            // Chebyshev distance (in nodes) to the sign change, one direction
+            // after the other
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                dist_tmp.copy<RunOn::Host>(dist);
+                amrex::LoopOnCpu(ext_box, [&] (int i, int j, int k) noexcept
+                {
+                    const IntVect iv(AMREX_D_DECL(i,j,k));
+                    int r = dt(iv);
+                    for (int off = 1; off < r; ++off) {
+                        for (int side = -1; side <= 1; side += 2) {
+                            const IntVect nb = iv + (side*off)*IntVect::TheDimensionVector(d);
+                            if (ext_box.contains(nb)) r = std::min(r, std::max(off, dt(nb)));
+                        }
+                    }
+                    dd(iv) = r;
+                });
+            }
+
+            FArrayBox guess(tile_box, 1);
+            auto const & g = guess.array();
+            const auto & free_tile = free_nd.array(mfi);
+
+            amrex::LoopOnCpu(tile_box, [&] (int i, int j, int k) noexcept
+            {
+                g(i,j,k) = (dd(i,j,k) <= band) ? 0.0 : ls_threshold;
+                const bool edge = ! inner_box.contains(IntVect(AMREX_D_DECL(i,j,k)));
+                free_tile(i,j,k) = (dd(i,j,k) > band && (dd(i,j,k) <= reach || edge)) ? 1 : 0;
+            });
+
+            amrex_eb_fill_levelset_loc(BL_TO_FORTRAN_BOX(tile_box),
+                                       facets->dataPtr(), & len_facets,
+                                       BL_TO_FORTRAN_3D(v_tile),
+                                       BL_TO_FORTRAN_3D(ls_tile),
+                                       BL_TO_FORTRAN_3D(guess),
+                                       & ls_threshold, dx.dataPtr(), dx_eb.dataPtr() );
+
+            region_tile.setVal<RunOn::Host>(1);
+        } else {
+            ls_tile.setVal<RunOn::Host>( ls_threshold, tile_box );
+        }
+
+        amrex_eb_threshold_levelset(BL_TO_FORTRAN_BOX(tile_box), & ls_threshold,
+                                    BL_TO_FORTRAN_3D(ls_tile));
+
+        amrex_eb_validate_levelset(BL_TO_FORTRAN_BOX(tile_box), & ls_ref,
+                                   BL_TO_FORTRAN_3D(if_tile),
+                                   BL_TO_FORTRAN_3D(v_tile),
+                                   BL_TO_FORTRAN_3D(ls_tile)   );
+    }
+
+
+    /****************************************************************************
+     *                                                                          *
+     * Fast-sweeping reinitialization of the nodes outside of the narrow band. *
+     * Each fab is swept on its own, and ghost nodes are exchanged until        *
+     * nothing changes anymore.                                                 *
+     *                                                                          *
+     ***************************************************************************/
+
+    int iter = 0;
+    for (bool changed = true; changed; ++iter)
+    {
+        data.FillBoundary(geom.periodicity());
+
+        changed = false;
+#ifdef _OPENMP
+#pragma omp parallel reduction(||:changed)
+#endif
+        for (MFIter mfi(data); mfi.isValid(); ++mfi)
+        {
+            // Ghost nodes only provide neighbor values, they are owned by other fabs
+            const Box & fab_box = data[mfi].box();
+            const Box bx = mfi.validbox() & active_box;
+            if (! bx.ok()) continue;
+            changed = fast_sweep(bx, data.array(mfi), free_nd.const_array(mfi),
+                                 fab_box, dx, ls_threshold) || changed;
+        }
+
+        ParallelDescriptor::ReduceBoolOr(changed);
+    }
+
+    return iter;
+}
+
+
+
 void LSFactory::fill_data (MultiFab & data, iMultiFab & valid,
                            const MultiFab & mf_impfunc,
                            int eb_pad, const Geometry & eb_geom) {
@@ -914,6 +1201,36 @@ std::unique_ptr<iMultiFab> LSFactory::Fill(const EBFArrayBoxFactory & eb_factory
 
 
 
+std::unique_ptr<iMultiFab> LSFactory::Update(const EBFArrayBoxFactory & eb_factory,
+                                             const MultiFab & mf_impfunc,
+                                             const RealBox & eb_region, int band) {
+
+    BL_PROFILE("LSFactory::Update()");
+
+    std::unique_ptr<iMultiFab> region_valid = std::unique_ptr<iMultiFab>(new iMultiFab);
+    region_valid->define(ls_ba, ls_dm, 1, ls_grid_pad);
+    region_valid->setVal(0);
+
+    // `eb_region` in the (nodal) index space of the level-set
+    const Real * problo = base_geom.ProbLo();
+    IntVect lo, hi;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        lo[idim] = static_cast<int>(std::floor((eb_region.lo(idim) - problo[idim]) / dx_vect[idim]));
+        hi[idim] = static_cast<int>(std::ceil ((eb_region.hi(idim) - problo[idim]) / dx_vect[idim]));
+    }
+    const Box update_box(lo, hi, IndexType::TheNodeType());
+
+    LSFactory::update_data(* ls_grid, * region_valid, eb_factory, mf_impfunc,
+                           IntVect{AMREX_D_DECL(eb_tile_size, eb_tile_size, eb_tile_size)},
+                           ls_grid_ref, eb_grid_ref, geom_ls, geom_eb, update_box, band);
+
+    fill_valid();
+
+    return region_valid;
+}
+
+
+
 std::unique_ptr<iMultiFab> LSFactory::Fill(const MultiFab & mf_impfunc,
                                            bool apply_threshold) {
 
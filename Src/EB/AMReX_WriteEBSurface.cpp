@@ -20,6 +20,10 @@
 #include <AMReX_EB_LSCore.H>
 #include <AMReX_WriteEBSurface.H>
 #include <AMReX_WriteEB_F.H>
+#include <AMReX_Utility.H>
+
+#include <cstdint>
+#include <fstream>
 
 namespace amrex {
 
@@ -77,5 +81,241 @@ void WriteEBSurface (const BoxArray & ba, const DistributionMapping & dmap, cons
     }
 }
 
+
+#if (AMREX_SPACEDIM == 3)
+
+namespace {
+
+    // Appends the polygon where the plane through `centroid` with normal `normal`
+    // cuts the cell [lo,lo+dx] to `points`, in counter-clockwise order around the
+    // normal. Returns the number of vertices, or 0 if the plane does not give a
+    // polygon.
+    int eb_cell_polygon (const RealArray& lo, const Real* dx, const RealArray& centroid,
+                         const RealArray& normal, Vector<float>& points)
+    {
+        RealArray pts[12];
+        int npts = 0;
+
+        // The 12 edges of the cell: 4 parallel to each direction
+        for (int dir = 0; dir < 3; ++dir)
+        {
+            if (std::abs(normal[dir]) <= std::numeric_limits<Real>::epsilon()) continue;
+            const int d1 = (dir+1)%3;
+            const int d2 = (dir+2)%3;
+            for (int e = 0; e < 4; ++e)
+            {
+                RealArray v = lo;
+                v[d1] += (e & 1) ? dx[d1] : 0.0;
+                v[d2] += (e & 2) ? dx[d2] : 0.0;
+                Real dist = 0.0;
+                for (int idim = 0; idim < 3; ++idim) {
+                    dist += normal[idim] * (centroid[idim] - v[idim]);
+                }
+                const Real alpha = dist / (normal[dir]*dx[dir]);
+                if (alpha > 0.0 && alpha < 1.0) {
+                    v[dir] += alpha*dx[dir];
+                    pts[npts++] = v;
+                }
+            }
+        }
+
+        if (npts < 3 || npts > 6) return 0;
+
+        // Sort the vertices by their angle around the center in the plane
+        RealArray center{0.0, 0.0, 0.0};
+        for (int i = 0; i < npts; ++i) {
+            for (int idim = 0; idim < 3; ++idim) center[idim] += pts[i][idim] / npts;
+        }
+        int dmax = 0;
+        for (int idim = 1; idim < 3; ++idim) {
+            if (std::abs(normal[idim]) > std::abs(normal[dmax])) dmax = idim;
+        }
+        // u and v span the plane, with u x v along the normal
+        RealArray u{0.0, 0.0, 0.0};
+        u[(dmax+1)%3] = 1.0;
+        const Real un = u[0]*normal[0] + u[1]*normal[1] + u[2]*normal[2];
+        for (int idim = 0; idim < 3; ++idim) u[idim] -= un*normal[idim];
+        const RealArray v{normal[1]*u[2]-normal[2]*u[1],
+                          normal[2]*u[0]-normal[0]*u[2],
+                          normal[0]*u[1]-normal[1]*u[0]};
+        Real angle[6];
+        int order[6];
+        for (int i = 0; i < npts; ++i) {
+            Real pu = 0.0, pv = 0.0;
+            for (int idim = 0; idim < 3; ++idim) {
+                pu += (pts[i][idim]-center[idim]) * u[idim];
+                pv += (pts[i][idim]-center[idim]) * v[idim];
+            }
+            angle[i] = std::atan2(pv, pu);
+            order[i] = i;
+        }
+        std::sort(order, order+npts, [&] (int a, int b) { return angle[a] < angle[b]; });
+
+        for (int i = 0; i < npts; ++i) {
+            for (int idim = 0; idim < 3; ++idim) {
+                points.push_back(static_cast<float>(pts[order[i]][idim]));
+            }
+        }
+        return npts;
+    }
+
+    template <class T>
+    void write_appended (std::ofstream& ofs, const Vector<T>& v)
+    {
+        const std::uint64_t nbytes = v.size()*sizeof(T);
+        ofs.write(reinterpret_cast<const char*>(&nbytes), sizeof(nbytes));
+        ofs.write(reinterpret_cast<const char*>(v.data()), nbytes);
+    }
+}
+
+void WriteEBSurfaceBinary (const std::string& dirname, const Geometry & geom,
+                           const EBFArrayBoxFactory & ebf)
+{
+    BL_PROFILE("amrex::WriteEBSurfaceBinary()");
+
+    const Real* dx = geom.CellSize();
+    const Real* problo = geom.ProbLo();
+
+    const auto& flags     = ebf.getMultiEBCellFlagFab();
+    const auto& bndrycent = ebf.getBndryCent();
+    const auto& bndrynorm = ebf.getBndryNormal();
+
+    // The polygons of each box, built in parallel
+    const int nlocal = flags.local_size();
+    Vector<Vector<float>> box_points(nlocal);
+    Vector<Vector<std::int64_t>> box_offsets(nlocal);
+
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+    for (MFIter mfi(flags); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.validbox();
+        if (flags[mfi].getType(bx) != FabType::singlevalued) continue;
+
+        auto const& flag = flags.const_array(mfi);
+        auto const& bcent = bndrycent.const_array(mfi);
+        auto const& bnorm = bndrynorm.const_array(mfi);
+        auto& points = box_points[mfi.LocalIndex()];
+        auto& offsets = box_offsets[mfi.LocalIndex()];
+
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+        {
+            if (!flag(i,j,k).isSingleValued()) return;
+            const IntVect iv(i,j,k);
+            RealArray lo, centroid, normal;
+            for (int idim = 0; idim < 3; ++idim) {
+                lo[idim] = problo[idim] + iv[idim]*dx[idim];
+                centroid[idim] = lo[idim] + (0.5 + bcent(i,j,k,idim))*dx[idim];
+                normal[idim] = bnorm(i,j,k,idim);
+            }
+            int n = eb_cell_polygon(lo, dx, centroid, normal, points);
+            if (n == 0) {
+                // The plane goes through a vertex or an edge of the cell, try
+                // again a little bit away from it
+                const Real tol = std::min({dx[0], dx[1], dx[2]}) / 100.;
+                for (int side = -1; side <= 1 && n == 0; side += 2) {
+                    RealArray c = centroid;
+                    for (int idim = 0; idim < 3; ++idim) c[idim] += side*tol*normal[idim];
+                    n = eb_cell_polygon(lo, dx, c, normal, points);
+                }
+            }
+            if (n > 0) offsets.push_back(points.size()/3);
+        });
+    }
+
+    // Concatenate the boxes
+    Vector<float> points;
+    Vector<std::int64_t> offsets;
+    for (int i = 0; i < nlocal; ++i) {
+        const std::int64_t npts_before = points.size()/3;
+        points.insert(points.end(), box_points[i].begin(), box_points[i].end());
+        for (auto o : box_offsets[i]) offsets.push_back(npts_before + o);
+        Vector<float>().swap(box_points[i]);
+    }
+    const std::int64_t npoints = points.size()/3;
+    const std::int64_t npolys = offsets.size();
+    Vector<std::int64_t> connectivity(npoints);
+    for (std::int64_t i = 0; i < npoints; ++i) connectivity[i] = i;
+
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(dirname, 0755)) {
+            amrex::CreateDirectoryFailed(dirname);
+        }
+    }
+    ParallelDescriptor::Barrier();
+
+    const int myproc = ParallelDescriptor::MyProc();
+    const std::string piece = amrex::Concatenate("eb_", myproc, 5) + ".vtp";
+    const int one = 1;
+    const std::string byte_order = (*reinterpret_cast<const char*>(&one) == 1)
+        ? "LittleEndian" : "BigEndian";
+
+    if (npolys > 0)
+    {
+        std::ofstream ofs(dirname + "/" + piece, std::ios::out | std::ios::binary);
+        if (!ofs.good()) amrex::FileOpenFailed(dirname + "/" + piece);
+
+        const std::uint64_t hsize = sizeof(std::uint64_t);
+        ofs << "<?xml version=\"1.0\"?>\n"
+            << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"" << byte_order
+            << "\" header_type=\"UInt64\">\n"
+            << "  <PolyData>\n"
+            << "    <Piece NumberOfPoints=\"" << npoints << "\" NumberOfVerts=\"0\" "
+            << "NumberOfLines=\"0\" NumberOfStrips=\"0\" NumberOfPolys=\"" << npolys << "\">\n"
+            << "      <Points>\n"
+            << "        <DataArray type=\"Float32\" NumberOfComponents=\"3\" "
+            << "format=\"appended\" offset=\"0\"/>\n"
+            << "      </Points>\n"
+            << "      <Polys>\n"
+            << "        <DataArray type=\"Int64\" Name=\"connectivity\" "
+            << "format=\"appended\" offset=\"" << hsize + points.size()*sizeof(float) << "\"/>\n"
+            << "        <DataArray type=\"Int64\" Name=\"offsets\" "
+            << "format=\"appended\" offset=\"" << 2*hsize + points.size()*sizeof(float)
+                                                  + connectivity.size()*sizeof(std::int64_t) << "\"/>\n"
+            << "      </Polys>\n"
+            << "    </Piece>\n"
+            << "  </PolyData>\n"
+            << "  <AppendedData encoding=\"raw\">\n"
+            << "_";
+        write_appended(ofs, points);
+        write_appended(ofs, connectivity);
+        write_appended(ofs, offsets);
+        ofs << "\n  </AppendedData>\n"
+            << "</VTKFile>\n";
+    }
+
+    // The index file lists the pieces of the processes with polygons
+    const std::vector<std::int64_t> all_npolys
+        = ParallelDescriptor::Gather(npolys, ParallelDescriptor::IOProcessorNumber());
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        std::string::size_type slash = dirname.find_last_of('/');
+        const std::string reldir = (slash == std::string::npos) ? dirname : dirname.substr(slash+1);
+
+        std::ofstream ofs(dirname + ".pvtp");
+        if (!ofs.good()) amrex::FileOpenFailed(dirname + ".pvtp");
+
+        ofs << "<?xml version=\"1.0\"?>\n"
+            << "<VTKFile type=\"PPolyData\" version=\"1.0\" byte_order=\"" << byte_order
+            << "\" header_type=\"UInt64\">\n"
+            << "  <PPolyData GhostLevel=\"0\">\n"
+            << "    <PPoints>\n"
+            << "      <PDataArray type=\"Float32\" NumberOfComponents=\"3\"/>\n"
+            << "    </PPoints>\n";
+        for (int iproc = 0; iproc < static_cast<int>(all_npolys.size()); ++iproc) {
+            if (all_npolys[iproc] > 0) {
+                ofs << "    <Piece Source=\"" << reldir << "/"
+                    << amrex::Concatenate("eb_", iproc, 5) << ".vtp\"/>\n";
+            }
+        }
+        ofs << "  </PPolyData>\n"
+            << "</VTKFile>\n";
+    }
+}
+
+#endif
+
 }
 
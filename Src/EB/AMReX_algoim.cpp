@@ -1,8 +1,14 @@
 #include <AMReX_algoim.H>
 #include <AMReX_EB2.H>
+#include <AMReX_ParmParse.H>
 #include <AMReX_Print.H>
 #include <AMReX_algoim_K.H>
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <list>
+
 namespace amrex { namespace algoim {
 
 void
@@ -185,4 +191,341 @@ compute_integrals (MultiFab& intgmf, IntVect nghost)
 #endif
 }
 
+
+#if (AMREX_SPACEDIM == 3)
+namespace {
+    void eval_integrals (QuadratureRule const& q, Real* intg) noexcept
+    {
+        intg[i_S_x    ] = q.eval([](Real x, Real  , Real  ) noexcept { return x; });
+        intg[i_S_y    ] = q.eval([](Real  , Real y, Real  ) noexcept { return y; });
+        intg[i_S_z    ] = q.eval([](Real  , Real  , Real z) noexcept { return z; });
+        intg[i_S_x2   ] = q.eval([](Real x, Real  , Real  ) noexcept { return x*x; });
+        intg[i_S_y2   ] = q.eval([](Real  , Real y, Real  ) noexcept { return y*y; });
+        intg[i_S_z2   ] = q.eval([](Real  , Real  , Real z) noexcept { return z*z; });
+        intg[i_S_x_y  ] = q.eval([](Real x, Real y, Real  ) noexcept { return x*y; });
+        intg[i_S_x_z  ] = q.eval([](Real x, Real  , Real z) noexcept { return x*z; });
+        intg[i_S_y_z  ] = q.eval([](Real  , Real y, Real z) noexcept { return y*z; });
+        intg[i_S_x2_y ] = q.eval([](Real x, Real y, Real  ) noexcept { return x*x*y; });
+        intg[i_S_x2_z ] = q.eval([](Real x, Real  , Real z) noexcept { return x*x*z; });
+        intg[i_S_x_y2 ] = q.eval([](Real x, Real y, Real  ) noexcept { return x*y*y; });
+        intg[i_S_y2_z ] = q.eval([](Real  , Real y, Real z) noexcept { return y*y*z; });
+        intg[i_S_x_z2 ] = q.eval([](Real x, Real  , Real z) noexcept { return x*z*z; });
+        intg[i_S_y_z2 ] = q.eval([](Real  , Real y, Real z) noexcept { return y*z*z; });
+        intg[i_S_x2_y2] = q.eval([](Real x, Real y, Real  ) noexcept { return x*x*y*y; });
+        intg[i_S_x2_z2] = q.eval([](Real x, Real  , Real z) noexcept { return x*x*z*z; });
+        intg[i_S_y2_z2] = q.eval([](Real  , Real y, Real z) noexcept { return y*y*z*z; });
+        intg[i_S_xyz  ] = q.eval([](Real x, Real y, Real z) noexcept { return x*y*z; });
+    }
+}
+#endif
+
+void
+compute_integrals (int n, Real const* bcent, Real const* bnorm, Real* intg)
+{
+#if (AMREX_SPACEDIM == 2)
+    amrex::ignore_unused(n,bcent,bnorm,intg);
+    amrex::Abort("amrex::algoim::compute_integrals is 3D only");
+#else
+    BL_PROFILE("algoim::compute_integrals(n)");
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,16)
+#endif
+    for (int i = 0; i < n; ++i)
+    {
+        EBPlane phi(bcent[3*i],bcent[3*i+1],bcent[3*i+2],
+                    bnorm[3*i],bnorm[3*i+1],bnorm[3*i+2]);
+        const QuadratureRule q = quadGen(phi);
+        eval_integrals(q, intg+numIntgs*i);
+    }
+#endif
+}
+
+std::size_t
+IntegralCache::KeyHash::operator() (Key const& key) const noexcept
+{
+    // FNV-1a over the bits of the key
+    std::uint64_t h = 14695981039346656037ULL;
+    unsigned char const* p = reinterpret_cast<unsigned char const*>(key.data());
+    for (std::size_t i = 0; i < sizeof(Key); ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void
+IntegralCache::eval (int n, Real const* bcent, Real const* bnorm, Real* intg)
+{
+    BL_PROFILE("algoim::IntegralCache::eval()");
+
+    auto make_key = [=] (int i) -> Key
+    {
+        Key key{bcent[3*i],bcent[3*i+1],bcent[3*i+2],
+                bnorm[3*i],bnorm[3*i+1],bnorm[3*i+2]};
+        // -0.0 and 0.0 are the same cut cell
+        for (auto& v : key) { if (v == 0.0) v = 0.0; }
+        return key;
+    };
+
+    const long stamp = ++m_nevals;
+
+    // Look up all cells; the map is only read here.
+    Vector<Entry*> found(n);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < n; ++i)
+    {
+        auto it = m_map.find(make_key(i));
+        found[i] = (it != m_map.end()) ? &(it->second) : nullptr;
+        if (found[i]) {
+            std::memcpy(intg+numIntgs*i, found[i]->intg.data(), numIntgs*sizeof(Real));
+        }
+    }
+
+    // The distinct cells that are missing
+    std::unordered_map<Key,int,KeyHash> missing;
+    Vector<int> first_missing;
+    Vector<int> copy_from(n, -1);
+    for (int i = 0; i < n; ++i) {
+        if (found[i]) {
+            found[i]->last_used = stamp;
+            continue;
+        }
+        auto r = missing.emplace(make_key(i), static_cast<int>(first_missing.size()));
+        if (r.second) {
+            first_missing.push_back(i);
+        } else {
+            copy_from[i] = first_missing[r.first->second];
+        }
+    }
+
+    const int nmiss = first_missing.size();
+    if (nmiss == 0) return;
+    Vector<Entry*>().swap(found);
+
+    Vector<Real> bc(3*nmiss), bn(3*nmiss), result(numIntgs*nmiss);
+    for (int m = 0; m < nmiss; ++m) {
+        for (int d = 0; d < 3; ++d) {
+            bc[3*m+d] = bcent[3*first_missing[m]+d];
+            bn[3*m+d] = bnorm[3*first_missing[m]+d];
+        }
+    }
+
+    compute_integrals(nmiss, bc.data(), bn.data(), result.data());
+
+    for (int m = 0; m < nmiss; ++m) {
+        Entry e;
+        std::memcpy(e.intg.data(), result.data()+numIntgs*m, numIntgs*sizeof(Real));
+        e.last_used = stamp;
+        m_map.emplace(make_key(first_missing[m]), e);
+        std::memcpy(intg+numIntgs*first_missing[m], e.intg.data(), numIntgs*sizeof(Real));
+    }
+    for (int i = 0; i < n; ++i) {
+        if (copy_from[i] >= 0) {
+            std::memcpy(intg+numIntgs*i, intg+numIntgs*copy_from[i], numIntgs*sizeof(Real));
+        }
+    }
+
+    trim();
+}
+
+void
+IntegralCache::setMaxSize (long max_size)
+{
+    m_max_size = max_size;
+    trim();
+}
+
+void
+IntegralCache::trim ()
+{
+    if (m_max_size <= 0 || size() <= m_max_size) return;
+
+    BL_PROFILE("algoim::IntegralCache::trim()");
+
+    // Keep the cells used last, down to the last_used of the m_max_size-th one.
+    Vector<long> last_used;
+    last_used.reserve(m_map.size());
+    for (auto const& kv : m_map) {
+        last_used.push_back(kv.second.last_used);
+    }
+    auto nth = last_used.begin() + (m_max_size-1);
+    std::nth_element(last_used.begin(), nth, last_used.end(), std::greater<long>());
+    const long cutoff = *nth;
+
+    for (auto it = m_map.begin(); it != m_map.end(); ) {
+        if (it->second.last_used < cutoff) {
+            it = m_map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    // Cells used at the same time as the cutoff
+    for (auto it = m_map.begin(); size() > m_max_size && it != m_map.end(); ) {
+        if (it->second.last_used == cutoff) {
+            it = m_map.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void
+compute_integrals (MultiFab& intgmf, IntVect nghost, IntegralCache& cache)
+{
+#if (AMREX_SPACEDIM == 2)
+    amrex::ignore_unused(intgmf,nghost,cache);
+    amrex::Abort("amrex::algoim::compute_integrals is 3D only");
+#else
+    if (Gpu::inLaunchRegion()) {
+        compute_integrals(intgmf, nghost);
+        return;
+    }
+
+    BL_PROFILE("algoim::compute_integrals(cache)");
+
+    nghost.min(intgmf.nGrowVect());
+    AMREX_ASSERT(intgmf.nComp() >= numIntgs);
+
+    const auto& my_factory = dynamic_cast<EBFArrayBoxFactory const&>(intgmf.Factory());
+
+    const MultiCutFab& bcent = my_factory.getBndryCent();
+    const MultiCutFab& bnorm = my_factory.getBndryNormal();
+    const auto&        flags = my_factory.getMultiEBCellFlagFab();
+
+    // Set the regular and covered cells, and gather the cut cells of all boxes
+    const int nlocal = intgmf.local_size();
+    Vector<Vector<IntVect>> cells(nlocal);
+    Vector<Vector<Real>> bc(nlocal), bn(nlocal);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(intgmf); mfi.isValid(); ++mfi)
+    {
+        const Box& bx = mfi.growntilebox(nghost);
+        Array4<Real> const& intg = intgmf.array(mfi);
+        const auto& flagfab = flags[mfi];
+        const auto typ = flagfab.getType(bx);
+        const int li = mfi.LocalIndex();
+
+        auto const& fg = flagfab.const_array();
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+        {
+            const bool covered = (typ == FabType::covered) ||
+                (typ != FabType::regular && fg(i,j,k).isCovered());
+            const bool regular = (typ == FabType::regular) ||
+                (typ != FabType::covered && fg(i,j,k).isRegular());
+            if (covered) {
+                for (int n = 0; n < numIntgs; ++n) intg(i,j,k,n) = 0.0;
+            } else if (regular) {
+                set_regular(i,j,k,intg);
+            } else {
+                auto const& bca = bcent.const_array(mfi);
+                auto const& bna = bnorm.const_array(mfi);
+                cells[li].push_back(IntVect(i,j,k));
+                for (int d = 0; d < 3; ++d) {
+                    bc[li].push_back(bca(i,j,k,d));
+                    bn[li].push_back(bna(i,j,k,d));
+                }
+            }
+        });
+    }
+
+    Vector<Real> all_bc, all_bn;
+    for (int li = 0; li < nlocal; ++li) {
+        all_bc.insert(all_bc.end(), bc[li].begin(), bc[li].end());
+        all_bn.insert(all_bn.end(), bn[li].begin(), bn[li].end());
+        Vector<Real>().swap(bc[li]);
+        Vector<Real>().swap(bn[li]);
+    }
+    const int ncells = all_bc.size()/3;
+    Vector<Real> all_intg(numIntgs*ncells);
+
+    cache.eval(ncells, all_bc.data(), all_bn.data(), all_intg.data());
+
+    Vector<int> offset(nlocal+1, 0);
+    for (int li = 0; li < nlocal; ++li) {
+        offset[li+1] = offset[li] + cells[li].size();
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    for (MFIter mfi(intgmf); mfi.isValid(); ++mfi)
+    {
+        Array4<Real> const& intg = intgmf.array(mfi);
+        const int li = mfi.LocalIndex();
+        for (int m = 0; m < static_cast<int>(cells[li].size()); ++m) {
+            const IntVect& iv = cells[li][m];
+            Real const* r = all_intg.data() + numIntgs*(offset[li]+m);
+            for (int n = 0; n < numIntgs; ++n) intg(iv,n) = r[n];
+        }
+    }
+#endif
+}
+
+namespace {
+    struct CacheEntry
+    {
+        EB2::Level const* level;
+        IntegralCache cache;
+    };
+
+    // The most recently used cache first
+    std::list<CacheEntry> the_caches;
+    long max_integral_cache_size = 262144;
+    bool caches_initialized = false;
+}
+
+IntegralCache&
+getIntegralCache (const MultiFab& intg)
+{
+    if (!caches_initialized) {
+        ParmParse pp("algoim");
+        pp.query("max_integral_cache_size", max_integral_cache_size);
+        max_integral_cache_size = std::max(max_integral_cache_size, 1L);
+        amrex::ExecOnFinalize(clearIntegralCaches);
+        caches_initialized = true;
+    }
+
+    const auto& my_factory = dynamic_cast<EBFArrayBoxFactory const&>(intg.Factory());
+    EB2::Level const* level = my_factory.getEBLevel();
+
+    // The integrals only depend on the boundary centroid and normal of the cut
+    // cells, so a cache that is found for a new level at the address of an old
+    // one does not give wrong results, only fewer hits.
+    auto it = std::find_if(the_caches.begin(), the_caches.end(),
+                           [&] (CacheEntry const& e) { return e.level == level; });
+    if (it != the_caches.end()) {
+        the_caches.splice(the_caches.begin(), the_caches, it);
+    } else {
+        the_caches.push_front(CacheEntry{level, IntegralCache()});
+    }
+
+    // Drop the caches of the other levels, starting with the one used least
+    // recently, while there are too many cells altogether.
+    long total = 0;
+    for (auto const& e : the_caches) {
+        total += e.cache.size();
+    }
+    while (the_caches.size() > 1 && total > max_integral_cache_size) {
+        total -= the_caches.back().cache.size();
+        the_caches.pop_back();
+    }
+
+    IntegralCache& cache = the_caches.front().cache;
+    cache.setMaxSize(max_integral_cache_size);
+    return cache;
+}
+
+void
+clearIntegralCaches ()
+{
+    the_caches.clear();
+    caches_initialized = false;
+}
+
 }}
@@ -151,9 +151,9 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
         }
         else
         {
+            // p = r + beta*(p - omega*v)
             const Real beta = (rho/rho_1)*(alpha/omega);
-            sxay(p, p, -omega, v, nghost);
-            sxay(p, r,   beta, p, nghost);
+            MultiFab::LinComb(p, 1.0, r, 0, beta, p, 0, -beta*omega, v, 0, 0, ncomp, nghost);
         }
         MultiFab::Copy(ph,p,0,0,ncomp,nghost);
         Lp.apply(amrlev, mglev, v, ph, MLLinOp::BCMode::Homogeneous, MLLinOp::StateMode::Correction);
@@ -168,12 +168,11 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
             ret = 2; break;
 	}
         sxay(sol, sol,  alpha, ph, nghost);
-        sxay(s,     r, -alpha,  v, nghost);
 
         //Subtract mean from s 
 //        if (Lp.isBottomSingular()) mlmg->makeSolvable(amrlev, mglev, s);
  
-        rnorm = norm_inf(s);
+        rnorm = sxay_norm_inf(s, r, -alpha, v);
 
         if ( verbose > 2 && ParallelDescriptor::IOProcessor() )
         {
@@ -191,12 +190,13 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
         //
         // This is a little funky.  I want to elide one of the reductions
         // in the following two dotxy()s.  We do that by calculating the "local"
-        // values and then reducing the two local values at the same time.
+        // values, in one pass over t, and then reducing the two local values at
+        // the same time.
         //
-        Real tvals[2] = { dotxy(t,t,true), dotxy(t,s,true) };
+        Vector<Real> tvals = Lp.xdoty(amrlev, mglev, t, {&t, &s}, true);
 
         BL_PROFILE_VAR("MLCGSolver::ParallelAllReduce", blp_par);
-        ParallelAllReduce::Sum(tvals,2,Lp.BottomCommunicator());
+        ParallelAllReduce::Sum(tvals.dataPtr(),2,Lp.BottomCommunicator());
         BL_PROFILE_VAR_STOP(blp_par);
 
         if ( tvals[0] )
@@ -208,11 +208,10 @@ MLCGSolver::solve_bicgstab (MultiFab&       sol,
             ret = 3; break;
 	}
         sxay(sol, sol,  omega, sh, nghost);
-        sxay(r,     s, -omega,  t, nghost);
 
 //        if (Lp.isBottomSingular()) mlmg->makeSolvable(amrlev, mglev, r);
 
-        rnorm = norm_inf(r);
+        rnorm = sxay_norm_inf(r, s, -omega, t);
 
         if ( verbose > 2 )
         {
@@ -348,8 +347,7 @@ MLCGSolver::solve_cg (MultiFab&       sol,
                            << " alpha " << alpha << '\n';
         }
         sxay(sol, sol, alpha, p, nghost);
-        sxay(  r,   r,-alpha, q, nghost);
-        rnorm = norm_inf(r);
+        rnorm = sxay_norm_inf(r, r, -alpha, q);
 
         if ( verbose > 2 )
         {
@@ -417,5 +415,19 @@ MLCGSolver::norm_inf (const MultiFab& res, bool local)
     return result;
 }
 
+Real
+MLCGSolver::sxay_norm_inf (MultiFab& ss, const MultiFab& xx, Real a, const MultiFab& yy)
+{
+    BL_PROFILE("CGSolver::sxay()");
+
+    Real result = MultiFab::LinCombNorm0(ss, 1.0, xx, 0, a, yy, 0, 0, ss.nComp(), nghost, true);
+
+    {
+        BL_PROFILE("MLCGSolver::ParallelAllReduce");
+        ParallelAllReduce::Max(result, Lp.BottomCommunicator());
+    }
+    return result;
+}
+
 
 }
@@ -841,6 +841,19 @@ MLCellLinOp::xdoty (int amrlev, int mglev, const MultiFab& x, const MultiFab& y,
     return result;
 }
 
+Vector<Real>
+MLCellLinOp::xdoty (int amrlev, int mglev, const MultiFab& x, const Vector<MultiFab const*>& y,
+                    bool local) const
+{
+    const int ncomp = getNComp();
+    const int nghost = 0;
+    Vector<Real> result = MultiFab::Dot(x,0,y,0,ncomp,nghost,true);
+    if (!local && !result.empty()) {
+        ParallelAllReduce::Sum(result.dataPtr(), result.size(), ParallelContext::CommunicatorSub());
+    }
+    return result;
+}
+
 MLCellLinOp::BndryCondLoc::BndryCondLoc (const BoxArray& ba, const DistributionMapping& dm, int ncomp)
     : bcond(ba, dm),
       bcloc(ba, dm),
@@ -154,8 +154,25 @@ MLLinOp::define (const Vector<Geometry>& a_geom,
     if (!a_factory.empty() and eb_limit_coarsening) {
         auto f = dynamic_cast<EBFArrayBoxFactory const*>(a_factory[0]);
         if (f) {
-            info.max_coarsening_level = std::min(info.max_coarsening_level,
-                                                 f->maxCoarseningLevel());
+            // Only ask for the EB levels defineGrids can actually use, so that
+            // levels left out by eb2.lazy_coarsening are not all built here.
+            Box bbx;
+            bool aggable = false;
+            if (info.do_agglomeration) {
+                bbx = a_grids[0].minimalBox();
+                aggable = (bbx.numPts() == a_grids[0].numPts());
+            }
+            int max_mglev = 0;
+            int rr = mg_coarsen_ratio;
+            while (max_mglev < info.max_coarsening_level
+                   and a_geom[0].Domain().coarsenable(rr, mg_domain_min_width)
+                   and ((aggable) ? bbx.coarsenable(rr, mg_box_min_width)
+                                  : a_grids[0].coarsenable(rr, mg_box_min_width)))
+            {
+                ++max_mglev;
+                rr *= mg_coarsen_ratio;
+            }
+            info.max_coarsening_level = std::min(max_mglev, f->maxCoarseningLevel(max_mglev));
         }
     }
 #endif
@@ -716,6 +733,20 @@ MLLinOp::makeConsolidatedDMap (const Vector<BoxArray>& ba, Vector<DistributionMa
     }
 }
 
+Vector<Real>
+MLLinOp::xdoty (int amrlev, int mglev, const MultiFab& x, const Vector<MultiFab const*>& y,
+                bool local) const
+{
+    Vector<Real> result;
+    for (auto const* yy : y) {
+        result.push_back(xdoty(amrlev, mglev, x, *yy, true));
+    }
+    if (!local && !result.empty()) {
+        ParallelAllReduce::Sum(result.dataPtr(), result.size(), ParallelContext::CommunicatorSub());
+    }
+    return result;
+}
+
 void
 MLLinOp::remapNeighborhoods (Vector<DistributionMapping> & dms)
 {
@@ -2381,7 +2381,8 @@ MLNodeLaplacian::buildIntegral ()
 #else
     for (int amrlev = 0; amrlev < m_num_amr_levels; ++amrlev)
     {
-        amrex::algoim::compute_integrals(*m_integral[amrlev]);
+        amrex::algoim::compute_integrals(*m_integral[amrlev], m_integral[amrlev]->nGrowVect(),
+                                         amrex::algoim::getIntegralCache(*m_integral[amrlev]));
     }
 #endif
 }
@@ -1,5 +1,11 @@
 #include <AMReX_ParticleUtil.H>
 
+#ifdef AMREX_MEM_PROFILING
+#include <AMReX_MemProfiler.H>
+#endif
+
+#include <atomic>
+
 namespace amrex
 {
 
@@ -65,4 +71,41 @@ Vector<int> computeNeighborProcs (const ParGDBBase* a_gdb, int ngrow)
     return neighbor_procs;
 }
 
+namespace {
+    std::atomic<long> particle_bytes{0};
+    std::atomic<long> particle_bytes_hwm{0};
+}
+
+void ParticleMemoryCounter::set (long bytes)
+{
+    if (bytes == m_bytes) return;
+
+#ifdef AMREX_MEM_PROFILING
+    static bool registered = false;
+    if (!registered) {
+        registered = true;
+        MemProfiler::add("Particles", std::function<MemProfiler::MemInfo()>
+                         ([] () -> MemProfiler::MemInfo {
+                             return {particle_bytes.load(), particle_bytes_hwm.load()};
+                         }));
+    }
+#endif
+
+    const long total = (particle_bytes += bytes - m_bytes);
+    m_bytes = bytes;
+
+    long hwm = particle_bytes_hwm.load();
+    while (total > hwm && !particle_bytes_hwm.compare_exchange_weak(hwm, total)) {}
+}
+
+long ParticleMemoryCounter::totalBytes () noexcept
+{
+    return particle_bytes.load();
+}
+
+long ParticleMemoryCounter::totalBytesHWM () noexcept
+{
+    return particle_bytes_hwm.load();
+}
+
 }
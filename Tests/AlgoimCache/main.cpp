@@ -0,0 +1,162 @@
+#include <AMReX.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_algoim.H>
+
+using namespace amrex;
+
+// Checks that the EB integrals computed with the cache returned by
+// algoim::getIntegralCache are the same as the ones computed without, on
+// the first call, when all cut cells are found in the cache, and on other
+// grids of the same EB level, which reuse the cache.  Then checks a cache
+// with a maximum size smaller than the number of distinct cut cells.
+
+namespace {
+
+struct Integrals
+{
+    Integrals (const Geometry& geom, const BoxArray& ba)
+        : dm(ba),
+          factory(makeEBFabFactory(geom, ba, dm, {1,1,1}, EBSupport::full)),
+          intg(ba, dm, algoim::numIntgs, 1, MFInfo(), *factory)
+    {}
+
+    DistributionMapping dm;
+    std::unique_ptr<EBFArrayBoxFactory> factory;
+    MultiFab intg;
+};
+
+Real maxDiff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), a.nGrow());
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), a.nGrow());
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), a.nGrow());
+    Real r = 0.0;
+    for (int n = 0; n < a.nComp(); ++n) {
+        r = std::max(r, d.norm0(n, d.nGrow()));
+    }
+    return r;
+}
+
+}
+
+void main_main ()
+{
+    int n_cell, max_grid_size;
+    {
+        ParmParse pp;
+        pp.get("n_cell", n_cell);
+        pp.get("max_grid_size", max_grid_size);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Geometry geom(domain, rb, 0, {AMREX_D_DECL(0,0,0)});
+
+    // A sphere cut by a plane, so that there are both curved and planar walls
+    EB2::SphereIF sphere(0.35, {AMREX_D_DECL(0.5,0.5,0.5)}, true);
+    EB2::PlaneIF plane({AMREX_D_DECL(0.5,0.5,0.6)}, {AMREX_D_DECL(0.,0.,1.)}, true);
+    auto gshop = EB2::makeShop(EB2::makeIntersection(sphere, plane));
+    EB2::Build(gshop, geom, 0, 0);
+
+    Real errmax = 0.0;
+    bool ok = true;
+    long ncached = 0;
+
+    // Different grids of the same geometry
+    for (int mgs : {max_grid_size, max_grid_size/2, max_grid_size})
+    {
+        BoxArray ba(domain);
+        ba.maxSize(mgs);
+
+        Integrals uncached(geom, ba);
+        algoim::compute_integrals(uncached.intg, uncached.intg.nGrowVect());
+
+        Integrals cached(geom, ba);
+        algoim::IntegralCache& cache = algoim::getIntegralCache(cached.intg);
+        long size_before = cache.size();
+        algoim::compute_integrals(cached.intg, cached.intg.nGrowVect(), cache);
+        long size_first = cache.size();
+        const Real e_first = maxDiff(uncached.intg, cached.intg);
+
+        cached.intg.setVal(0.0);
+        algoim::compute_integrals(cached.intg, cached.intg.nGrowVect(),
+                                  algoim::getIntegralCache(cached.intg));
+        long size_second = cache.size();
+        const Real e_second = maxDiff(uncached.intg, cached.intg);
+
+        // The caches are local, and some processes may not have any cut cells.
+        // The processes that own the cut cells change with the grids, so only
+        // the first grids are sure to find every cell in the cache.
+        Vector<long> sizes{size_before, size_first, size_second};
+        ParallelDescriptor::ReduceLongSum(sizes.data(), sizes.size());
+
+        amrex::Print() << "max_grid_size = " << mgs << ": cache size "
+                       << sizes[0] << " -> " << sizes[1] << " -> " << sizes[2]
+                       << ", max diff " << e_first << " (first call), "
+                       << e_second << " (all cells cached)\n";
+
+        errmax = std::max({errmax, e_first, e_second});
+        // The cache is kept across the grids, and the second call finds all cut cells.
+        ok = ok && (ncached == 0 ? sizes[0] == 0 : sizes[0] >= ncached)
+                && sizes[1] > 0 && sizes[2] == sizes[1];
+        if (ParallelDescriptor::NProcs() == 1 && ncached > 0) {
+            // On one process, the new grids have no cut cells that are not cached.
+            ok = ok && sizes[1] == ncached;
+        }
+        ncached = sizes[1];
+    }
+
+    // A cache holding fewer cells than there are distinct cut cells
+    {
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+
+        Integrals uncached(geom, ba);
+        algoim::compute_integrals(uncached.intg, uncached.intg.nGrowVect());
+
+        algoim::IntegralCache cache;
+        Integrals cached(geom, ba);
+        algoim::compute_integrals(cached.intg, cached.intg.nGrowVect(), cache);
+        const long ndistinct = cache.size();
+        const long max_size = std::max(ndistinct/3, 1L);
+        cache.setMaxSize(max_size);
+        long size_trimmed = cache.size();
+
+        Real e = 0.0;
+        long size_max = size_trimmed;
+        for (int iter = 0; iter < 2; ++iter) {
+            cached.intg.setVal(0.0);
+            algoim::compute_integrals(cached.intg, cached.intg.nGrowVect(), cache);
+            size_max = std::max(size_max, cache.size());
+            e = std::max(e, maxDiff(uncached.intg, cached.intg));
+        }
+
+        amrex::Print() << "Cache with a maximum size of " << max_size << " cells (rank 0): "
+                       << ndistinct << " distinct cut cells, " << size_trimmed
+                       << " cells after trimming, max diff " << e << "\n";
+
+        errmax = std::max(errmax, e);
+        ok = ok && size_trimmed == std::min(ndistinct, max_size) && size_max <= max_size;
+    }
+
+    if (ok && errmax == 0.0) {
+        amrex::Print() << "SUCCESS\n";
+    } else {
+        amrex::Abort("The cached EB integrals do not match the uncached ones");
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        main_main();
+    }
+    amrex::Finalize();
+    return 0;
+}
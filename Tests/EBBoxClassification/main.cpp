@@ -0,0 +1,161 @@
+#include <AMReX.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+// Builds the EB of several implicit functions with bounds, for which
+// GShopLevel classifies the boxes coarse to fine, and of the same functions
+// hidden behind a wrapper without bounds, for which every box is sampled.
+// The cut and covered boxes, the cell flags and the volume fractions have
+// to be the same.
+
+namespace {
+
+// The same implicit function, without bounds
+template <class F>
+class NoBounds
+    : public GPUable
+{
+public:
+    explicit NoBounds (F const& f) : m_f(f) {}
+
+    AMREX_GPU_HOST_DEVICE inline
+    Real operator() (AMREX_D_DECL(Real x, Real y, Real z)) const noexcept {
+        return m_f(AMREX_D_DECL(x,y,z));
+    }
+
+    inline Real operator() (const RealArray& p) const noexcept {
+        return m_f(p);
+    }
+
+private:
+    F m_f;
+};
+
+Vector<Box> sortedBoxes (const BoxArray& ba)
+{
+    Vector<Box> r;
+    for (int i = 0; i < ba.size(); ++i) r.push_back(ba[i]);
+    std::sort(r.begin(), r.end());
+    return r;
+}
+
+Real maxDiff (const MultiFab& a, MultiFab& b)
+{
+    MultiFab::Subtract(b, a, 0, 0, a.nComp(), a.nGrow());
+    return b.norm0(0, a.nGrow());
+}
+
+int compareCellFlag (const BoxArray& ba, const DistributionMapping& dm, int ng,
+                     const EB2::Level& lev0, const EB2::Level& lev1, const Geometry& geom)
+{
+    FabArray<EBCellFlagFab> a(ba, dm, 1, ng);
+    FabArray<EBCellFlagFab> b(ba, dm, 1, ng);
+    lev0.fillEBCellFlag(a, geom);
+    lev1.fillEBCellFlag(b, geom);
+    int nbad = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        auto const& af = a.const_array(mfi);
+        auto const& bf = b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k) noexcept
+        {
+            if (af(i,j,k).getValue() != bf(i,j,k).getValue()) ++nbad;
+        });
+    }
+    ParallelDescriptor::ReduceIntSum(nbad);
+    return nbad;
+}
+
+template <class F>
+bool check (const std::string& name, F const& f, const Geometry& geom, int max_grid_size)
+{
+    EB2::Build(EB2::makeShop(f), geom, 0, 0);
+    const EB2::Level& lev0 = EB2::IndexSpace::top().getLevel(geom);
+    EB2::Build(EB2::makeShop(NoBounds<F>(f)), geom, 0, 0);
+    const EB2::Level& lev1 = EB2::IndexSpace::top().getLevel(geom);
+
+    const bool same_cut = sortedBoxes(lev0.boxArray()) == sortedBoxes(lev1.boxArray());
+    const bool same_covered = sortedBoxes(lev0.coveredBoxArray())
+        == sortedBoxes(lev1.coveredBoxArray());
+
+    BoxArray ba(geom.Domain());
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+    const int ng = 2;
+    const int nbad = compareCellFlag(ba, dm, ng, lev0, lev1, geom);
+    MultiFab v0(ba, dm, 1, ng), v1(ba, dm, 1, ng);
+    lev0.fillVolFrac(v0, geom);
+    lev1.fillVolFrac(v1, geom);
+    const Real err = maxDiff(v0, v1);
+
+    amrex::Print() << name << ": " << lev0.boxArray().size() << " cut and "
+                   << lev0.coveredBoxArray().size() << " covered boxes"
+                   << (same_cut ? "" : ", cut boxes differ")
+                   << (same_covered ? "" : ", covered boxes differ")
+                   << ", cells with different flags " << nbad
+                   << ", volfrac max diff " << err << "\n";
+
+    EB2::IndexSpace::clear();
+    return same_cut && same_covered && nbad == 0 && err == 0.0;
+}
+
+}
+
+void main_main ()
+{
+    int n_cell, max_grid_size;
+    {
+        ParmParse pp;
+        pp.get("n_cell", n_cell);
+        pp.get("max_grid_size", max_grid_size);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Geometry geom(domain, rb, 0, {AMREX_D_DECL(0,0,0)});
+
+    EB2::SphereIF sphere_in(0.3, {AMREX_D_DECL(0.5,0.5,0.5)}, true);
+    EB2::SphereIF sphere_out(0.25, {AMREX_D_DECL(0.4,0.55,0.5)}, false);
+    EB2::BoxIF box_in({AMREX_D_DECL(0.1,0.15,0.2)}, {AMREX_D_DECL(0.8,0.9,0.7)}, true);
+    EB2::BoxIF box_out({AMREX_D_DECL(0.3,0.2,0.35)}, {AMREX_D_DECL(0.6,0.7,0.55)}, false);
+    EB2::PlaneIF plane({AMREX_D_DECL(0.5,0.5,0.5)}, {AMREX_D_DECL(0.3,-0.5,0.8)}, false);
+    EB2::SphereIF sphere_far(0.12, {AMREX_D_DECL(0.82,0.2,0.75)}, false);
+    EB2::EllipsoidIF ellipsoid({AMREX_D_DECL(0.35,0.2,0.25)}, {AMREX_D_DECL(0.5,0.5,0.5)}, false);
+
+    bool ok = true;
+    ok = check("sphere, fluid inside", sphere_in, geom, max_grid_size) && ok;
+    ok = check("sphere, fluid outside", sphere_out, geom, max_grid_size) && ok;
+    ok = check("box, fluid inside", box_in, geom, max_grid_size) && ok;
+    ok = check("box, fluid outside", box_out, geom, max_grid_size) && ok;
+    ok = check("plane", plane, geom, max_grid_size) && ok;
+    ok = check("ellipsoid", ellipsoid, geom, max_grid_size) && ok;
+    ok = check("complement", EB2::makeComplement(sphere_out), geom, max_grid_size) && ok;
+    ok = check("translation", EB2::translate(sphere_out, {AMREX_D_DECL(0.1,-0.05,0.)}),
+               geom, max_grid_size) && ok;
+    ok = check("union", EB2::makeUnion(sphere_out, sphere_far), geom, max_grid_size) && ok;
+    ok = check("intersection", EB2::makeIntersection(sphere_in, sphere_far), geom, max_grid_size) && ok;
+    ok = check("difference", EB2::makeDifference(sphere_in, sphere_far), geom, max_grid_size) && ok;
+
+    if (ok) {
+        amrex::Print() << "SUCCESS\n";
+    } else {
+        amrex::Abort("The EB boxes classified with bounds differ from the sampled ones");
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        main_main();
+    }
+    amrex::Finalize();
+    return 0;
+}
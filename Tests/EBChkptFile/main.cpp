@@ -0,0 +1,283 @@
+#include <AMReX.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_PlotFileUtil.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+#include <limits>
+#include <map>
+
+using namespace amrex;
+
+// Writes the EB of a sphere with EB2::WriteChkptFile, reads it back with
+// EB2::BuildFromChkptFile, and checks that the level set and the cut-cell
+// data of every level are the same, with and without eb2.lazy_coarsening.
+// The EB read back is written again, and the two checkpoints are compared,
+// ghost cells included.  Finally, the EB2::Build that reads eb2.geom_type has
+// to reuse its checkpoint unless a parameter of the geometry changes.
+
+namespace {
+
+Real maxDiff (const MultiFab& a, MultiFab& b)
+{
+    const int ng = a.nGrow();
+    MultiFab::Subtract(b, a, 0, 0, a.nComp(), ng);
+    Real r = 0.0;
+    for (int n = 0; n < a.nComp(); ++n) {
+        r = std::max(r, b.norm0(n, ng));
+    }
+    return r;
+}
+
+template <typename F>
+Real compare (const BoxArray& ba, const DistributionMapping& dm, int ncomp, int ng,
+              const EB2::Level& lev0, const EB2::Level& lev1, F&& fill)
+{
+    MultiFab a(ba, dm, ncomp, ng);
+    MultiFab b(ba, dm, ncomp, ng);
+    fill(lev0, a);
+    fill(lev1, b);
+    return maxDiff(a, b);
+}
+
+int compareCellFlag (const BoxArray& ba, const DistributionMapping& dm, int ng,
+                     const EB2::Level& lev0, const EB2::Level& lev1, const Geometry& geom)
+{
+    FabArray<EBCellFlagFab> a(ba, dm, 1, ng);
+    FabArray<EBCellFlagFab> b(ba, dm, 1, ng);
+    lev0.fillEBCellFlag(a, geom);
+    lev1.fillEBCellFlag(b, geom);
+    int nbad = 0;
+    for (MFIter mfi(a); mfi.isValid(); ++mfi)
+    {
+        auto const& af = a.const_array(mfi);
+        auto const& bf = b.const_array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), [&] (int i, int j, int k) noexcept
+        {
+            if (af(i,j,k).getValue() != bf(i,j,k).getValue()) ++nbad;
+        });
+    }
+    ParallelDescriptor::ReduceIntSum(nbad);
+    return nbad;
+}
+
+Real compareFiles (const std::string& name0, const std::string& name1)
+{
+    MultiFab a;
+    VisMF::Read(a, name0);
+    VisMF vismf(name1);
+    AMREX_ALWAYS_ASSERT(vismf.boxArray() == a.boxArray() && vismf.nComp() == a.nComp());
+    if (vismf.nGrowVect() != a.nGrowVect()) {
+        amrex::Print() << name1 << " has " << vismf.nGrowVect() << " ghost cells instead of "
+                       << a.nGrowVect() << "\n";
+        return std::numeric_limits<Real>::max();
+    }
+    MultiFab b(a.boxArray(), a.DistributionMap(), a.nComp(), a.nGrowVect());
+    VisMF::Read(b, name1);
+    return maxDiff(a, b);
+}
+
+// Compares the levels of is0 with those of is1, read back from chkpt_file, and
+// the checkpoint written again from is1 with chkpt_file.  Returns the max
+// difference and adds the number of cells with different flags to nbad.
+Real checkChkpt (const EB2::IndexSpace& is0, const EB2::IndexSpace& is1, const Geometry& geom,
+                 int max_grid_size, const std::string& chkpt_file, std::uint64_t hash,
+                 int& nbad)
+{
+    const Box& domain = geom.Domain();
+    const int ng = 2;
+    Real errmax = 0.0;
+    Box dom = domain;
+    for (int ilev = 0; ; ++ilev)
+    {
+        const Geometry& lgeom = is0.getGeometry(dom);
+        const EB2::Level& lev0 = is0.getLevel(lgeom);
+        const EB2::Level& lev1 = is1.getLevel(lgeom);
+
+        BoxArray ba(dom);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        nbad += compareCellFlag(ba, dm, ng, lev0, lev1, lgeom);
+
+        std::map<std::string,Real> err;
+        err["levelset"] = compare(amrex::convert(ba,IntVect::TheNodeVector()), dm, 1, ng,
+                                  lev0, lev1, [&] (const EB2::Level& l, MultiFab& mf)
+                                  { l.fillLevelSet(mf, lgeom); });
+        err["volfrac"] = compare(ba, dm, 1, ng, lev0, lev1,
+                                 [&] (const EB2::Level& l, MultiFab& mf)
+                                 { l.fillVolFrac(mf, lgeom); });
+        err["centroid"] = compare(ba, dm, AMREX_SPACEDIM, ng, lev0, lev1,
+                                  [&] (const EB2::Level& l, MultiFab& mf)
+                                  { l.fillCentroid(mf, lgeom); });
+        err["bndryarea"] = compare(ba, dm, 1, ng, lev0, lev1,
+                                   [&] (const EB2::Level& l, MultiFab& mf)
+                                   { l.fillBndryArea(mf, lgeom); });
+        err["bndrycent"] = compare(ba, dm, AMREX_SPACEDIM, ng, lev0, lev1,
+                                   [&] (const EB2::Level& l, MultiFab& mf)
+                                   { l.fillBndryCent(mf, lgeom); });
+        err["bndrynorm"] = compare(ba, dm, AMREX_SPACEDIM, ng, lev0, lev1,
+                                   [&] (const EB2::Level& l, MultiFab& mf)
+                                   { l.fillBndryNorm(mf, lgeom); });
+        Array<MultiFab,AMREX_SPACEDIM> a0, a1, c0, c1;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            const BoxArray& fba = amrex::convert(ba, IntVect::TheDimensionVector(idim));
+            a0[idim].define(fba, dm, 1, ng);
+            a1[idim].define(fba, dm, 1, ng);
+            c0[idim].define(fba, dm, AMREX_SPACEDIM-1, ng);
+            c1[idim].define(fba, dm, AMREX_SPACEDIM-1, ng);
+        }
+        lev0.fillAreaFrac({AMREX_D_DECL(&a0[0],&a0[1],&a0[2])}, lgeom);
+        lev1.fillAreaFrac({AMREX_D_DECL(&a1[0],&a1[1],&a1[2])}, lgeom);
+        lev0.fillFaceCent({AMREX_D_DECL(&c0[0],&c0[1],&c0[2])}, lgeom);
+        lev1.fillFaceCent({AMREX_D_DECL(&c1[0],&c1[1],&c1[2])}, lgeom);
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            err["areafrac_"+std::to_string(idim)] = maxDiff(a0[idim], a1[idim]);
+            err["facecent_"+std::to_string(idim)] = maxDiff(c0[idim], c1[idim]);
+        }
+
+        for (auto const& kv : err) {
+            amrex::Print() << "Level " << ilev << " " << kv.first << ": max diff = "
+                           << kv.second << "\n";
+            errmax = std::max(errmax, kv.second);
+        }
+
+        if (dom == is0.coarsestDomain()) break;
+        dom.coarsen(2);
+    }
+
+    // The levels read back have to hold the same data as the ones written.
+    const std::string chkpt_file_2 = chkpt_file + "_2";
+    EB2::WriteChkptFile(chkpt_file_2, geom, hash);
+    dom = domain;
+    for (int ilev = 0; ; ++ilev)
+    {
+        const std::string dir0 = amrex::LevelFullPath(ilev, chkpt_file);
+        const std::string dir1 = amrex::LevelFullPath(ilev, chkpt_file_2);
+        Vector<std::string> names{"cellflag", "levelset", "volfrac", "centroid",
+                                  "bndryarea", "bndrycent", "bndrynorm"};
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            names.push_back("areafrac_"+std::to_string(idim));
+            names.push_back("facecent_"+std::to_string(idim));
+        }
+        for (auto const& name : names) {
+            if (VisMF::Exist(dir0+"/"+name)) {
+                const Real e = compareFiles(dir0+"/"+name, dir1+"/"+name);
+                amrex::Print() << dir1 << "/" << name << ": max diff = " << e << "\n";
+                errmax = std::max(errmax, e);
+            }
+        }
+
+        if (dom == is0.coarsestDomain()) break;
+        dom.coarsen(2);
+    }
+
+    return errmax;
+}
+
+bool isFromChkptFile ()
+{
+    return dynamic_cast<EB2::IndexSpaceChkptFile const*>(&EB2::IndexSpace::top()) != nullptr;
+}
+
+}
+
+void main_main ()
+{
+    int n_cell, max_grid_size, max_coarsening_level;
+    std::string chkpt_file = "eb_chkpt";
+    {
+        ParmParse pp;
+        pp.get("n_cell", n_cell);
+        pp.get("max_grid_size", max_grid_size);
+        pp.get("max_coarsening_level", max_coarsening_level);
+        pp.query("chkpt_file", chkpt_file);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Geometry geom(domain, rb, 0, {AMREX_D_DECL(0,0,0)});
+
+    Real errmax = 0.0;
+    int nbad = 0;
+
+    // With eb2.lazy_coarsening, only the finest level is built before the
+    // checkpoint is written, and the coarse levels have to be written anyway.
+    for (int lazy = 0; lazy <= 1; ++lazy)
+    {
+        amrex::Print() << "eb2.lazy_coarsening = " << lazy << "\n";
+        EB2::lazy_coarsening = lazy;
+
+        EB2::SphereIF sphere(0.3, {AMREX_D_DECL(0.5,0.5,0.5)}, false);
+        auto gshop = EB2::makeShop(sphere);
+        EB2::Build(gshop, geom, 0, max_coarsening_level);
+        const EB2::IndexSpace& is0 = EB2::IndexSpace::top();
+
+        const std::uint64_t hash = EB2::GeometryHash(geom, 0, max_coarsening_level, 4, true,
+                                                     "sphere r=0.3 c=0.5");
+        const std::string fname = chkpt_file + "_lazy" + std::to_string(lazy);
+        EB2::WriteChkptFile(fname, geom, hash);
+        AMREX_ALWAYS_ASSERT(EB2::BuildFromChkptFile(fname, geom, hash));
+        const EB2::IndexSpace& is1 = EB2::IndexSpace::top();
+
+        AMREX_ALWAYS_ASSERT(is1.coarsestDomain() == is0.coarsestDomain());
+        AMREX_ALWAYS_ASSERT(is1.coarsestDomain() == amrex::coarsen(domain, 1 << max_coarsening_level));
+
+        errmax = std::max(errmax, checkChkpt(is0, is1, geom, max_grid_size, fname, hash, nbad));
+        EB2::IndexSpace::clear();
+    }
+    EB2::lazy_coarsening = false;
+
+    // The Build that reads eb2.geom_type reads the checkpoint back if only
+    // parameters that do not change the geometry have changed.
+    {
+        ParmParse pp("eb2");
+        pp.add("geom_type", std::string("sphere"));
+        pp.addarr("sphere_center", std::vector<Real>{AMREX_D_DECL(0.5,0.5,0.5)});
+        pp.add("sphere_radius", 0.3);
+        pp.add("sphere_has_fluid_inside", 0);
+        pp.add("chkpt_file", chkpt_file + "_pp");
+        amrex::UtilCreateDirectoryDestructive(chkpt_file + "_pp");
+
+        EB2::Build(geom, 0, max_coarsening_level);
+        const bool first = isFromChkptFile();
+        EB2::IndexSpace::clear();
+
+        pp.add("lazy_coarsening", 1);
+        EB2::Build(geom, 0, max_coarsening_level);
+        const bool second = isFromChkptFile();
+        EB2::IndexSpace::clear();
+
+        pp.add("sphere_radius", 0.25);
+        EB2::Build(geom, 0, max_coarsening_level);
+        const bool third = isFromChkptFile();
+        EB2::IndexSpace::clear();
+
+        amrex::Print() << "Read from " << chkpt_file << "_pp: " << first << " " << second
+                       << " " << third << "\n";
+        if (first || !second || third) {
+            amrex::Abort("EB2::Build does not reuse the checkpoint for the same geometry only");
+        }
+    }
+
+    amrex::Print() << "Cells with different flags: " << nbad << "\n";
+    if (errmax == 0.0 && nbad == 0) {
+        amrex::Print() << "SUCCESS\n";
+    } else {
+        amrex::Abort("EB2 checkpoint file does not match the geometry it was written from");
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        main_main();
+    }
+    amrex::Finalize();
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include <AMReX.H>
+#include <AMReX_CutCellList.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+// Builds a MultiCutCellList from an EBFArrayBoxFactory with EBSupport::full and
+// checks that every box lists exactly its cut cells, valid and ghost, and that
+// the moments of every cut cell are those of the dense factory data.
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 64;
+        int max_grid_size = 16;
+        int ngrow = 2;
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("ngrow", ngrow);
+        }
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+        Geometry geom(domain, rb, 0, {AMREX_D_DECL(0,0,0)});
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        EB2::SphereIF sphere(0.3, {AMREX_D_DECL(0.5,0.45,0.55)}, false);
+        EB2::Build(EB2::makeShop(sphere), geom, 0, 0);
+        EBFArrayBoxFactory factory(EB2::IndexSpace::top().getLevel(geom), geom, ba, dm,
+                                   {ngrow,ngrow,ngrow}, EBSupport::full);
+
+        MultiCutCellList cutcells(factory, ngrow);
+        AMREX_ALWAYS_ASSERT(cutcells.nGrow() == ngrow);
+
+        const auto& flags = factory.getMultiEBCellFlagFab();
+        const auto& volfrac = factory.getVolFrac();
+        const auto& centroid = factory.getCentroid();
+        const auto& bndryarea = factory.getBndryArea();
+        const auto& bndrycent = factory.getBndryCent();
+        const auto& bndrynorm = factory.getBndryNormal();
+        const auto areafrac = factory.getAreaFrac();
+        const auto facecent = factory.getFaceCent();
+
+        long ncut = 0;
+        long nwrong_cells = 0;
+        long dense_bytes = 0;
+        Gpu::DeviceScalar<int> nwrong_gpu(0);
+        int* nwrong = nwrong_gpu.dataPtr();
+
+        for (MFIter mfi(flags); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = amrex::grow(mfi.validbox(), ngrow);
+            const CutCellView cc = cutcells.const_view(mfi);
+
+            // The listed cells are the cut cells of the grown box, in order
+            int ncut_box = 0;
+            auto const& flag = flags.const_array(mfi);
+            amrex::LoopOnCpu(bx, [&] (int i, int j, int k) noexcept
+            {
+                if (flag(i,j,k).isSingleValued()) {
+                    if (ncut_box >= cc.size()
+                        || cc.cell(ncut_box) != IntVect(AMREX_D_DECL(i,j,k))) {
+                        ++nwrong_cells;
+                    }
+                    ++ncut_box;
+                }
+            });
+            if (ncut_box != cc.size()) ++nwrong_cells;
+            ncut += ncut_box;
+            if (cc.size() == 0) continue;
+
+            dense_bytes += bx.numPts()*CutCellView::ncomp*sizeof(Real);
+
+            AMREX_ALWAYS_ASSERT(centroid.ok(mfi));
+            auto const& vf = volfrac.const_array(mfi);
+            auto const& ct = centroid.const_array(mfi);
+            auto const& barea = bndryarea.const_array(mfi);
+            auto const& bc = bndrycent.const_array(mfi);
+            auto const& bn = bndrynorm.const_array(mfi);
+            AMREX_D_TERM(auto const& afx = areafrac[0]->const_array(mfi);,
+                         auto const& afy = areafrac[1]->const_array(mfi);,
+                         auto const& afz = areafrac[2]->const_array(mfi);)
+            AMREX_D_TERM(auto const& fcx = facecent[0]->const_array(mfi);,
+                         auto const& fcy = facecent[1]->const_array(mfi);,
+                         auto const& fcz = facecent[2]->const_array(mfi);)
+
+            amrex::ParallelFor(cc.size(), [=] AMREX_GPU_DEVICE (int n) noexcept
+            {
+                const IntVect iv = cc.cell(n);
+                bool same = cc.volfrac(n) == vf(iv) && cc.bndryarea(n) == barea(iv);
+                for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                    same = same && cc.centroid(n,dir) == ct(iv,dir)
+                                && cc.bndrycent(n,dir) == bc(iv,dir)
+                                && cc.bndrynorm(n,dir) == bn(iv,dir);
+                }
+                const Array4<Real const> af[AMREX_SPACEDIM] = {AMREX_D_DECL(afx,afy,afz)};
+                const Array4<Real const> fc[AMREX_SPACEDIM] = {AMREX_D_DECL(fcx,fcy,fcz)};
+                for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                    for (int side = 0; side < 2; ++side) {
+                        const IntVect ivf = iv + IntVect::TheDimensionVector(dir)*side;
+                        same = same && cc.areafrac(n,dir,side) == af[dir](ivf);
+                        for (int d = 0; d < AMREX_SPACEDIM-1; ++d) {
+                            same = same && cc.facecent(n,dir,side,d) == fc[dir](ivf,d);
+                        }
+                    }
+                }
+                if (!same) Gpu::Atomic::Add(nwrong, 1);
+            });
+        }
+
+        AMREX_ALWAYS_ASSERT(cutcells.numCutCells() == ncut);
+        long list_bytes = cutcells.nbytes();
+        long nwrong_moments = nwrong_gpu.dataValue();
+
+        ParallelDescriptor::ReduceLongSum(ncut);
+        ParallelDescriptor::ReduceLongSum(nwrong_cells);
+        ParallelDescriptor::ReduceLongSum(nwrong_moments);
+        ParallelDescriptor::ReduceLongSum(list_bytes);
+        ParallelDescriptor::ReduceLongSum(dense_bytes);
+
+        amrex::Print() << ncut << " cut cells, " << nwrong_cells << " wrong cells, "
+                       << nwrong_moments << " with wrong moments, " << list_bytes
+                       << " bytes instead of " << dense_bytes << "\n";
+
+        if (ncut == 0 || nwrong_cells != 0 || nwrong_moments != 0 || list_bytes >= dense_bytes) {
+            amrex::Abort("MultiCutCellList differs from the dense EB data");
+        }
+        amrex::Print() << "SUCCESS\n";
+    }
+    amrex::Finalize();
+}
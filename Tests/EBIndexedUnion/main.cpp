@@ -0,0 +1,143 @@
+#include <AMReX.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Random.H>
+
+#include <cmath>
+#include <limits>
+
+using namespace amrex;
+
+// Compares IndexedUnionIF of many spheres with the union evaluated over all of
+// the spheres: the sign everywhere, the value where it is not negative, and the
+// bounds at random points. Then builds the EB of a lattice of spheres with both.
+// The volume of the bodies has to be the same, and close to the exact one.
+
+namespace {
+
+// The union of all of the spheres, without an index and without bounds
+class BruteForceUnion
+{
+public:
+    explicit BruteForceUnion (const Vector<EB2::SphereIF>& a_fs) : m_fs(a_fs) {}
+
+    Real operator() (const RealArray& p) const noexcept
+    {
+        Real r = std::numeric_limits<Real>::lowest();
+        for (auto const& f : m_fs) r = std::max(r, f(p));
+        return r;
+    }
+
+private:
+    Vector<EB2::SphereIF> m_fs;
+};
+
+RealBox sphereBox (const RealArray& c, Real r)
+{
+    return RealBox({c[0]-r, c[1]-r, c[2]-r}, {c[0]+r, c[1]+r, c[2]+r});
+}
+
+Real bodyVolume (const Geometry& geom)
+{
+    const EB2::Level& lev = EB2::IndexSpace::top().getLevel(geom);
+    BoxArray ba(geom.Domain());
+    ba.maxSize(32);
+    DistributionMapping dm(ba);
+    MultiFab vfrac(ba, dm, 1, 0);
+    lev.fillVolFrac(vfrac, geom);
+    vfrac.mult(-1.0);
+    vfrac.plus(1.0, 0);
+    return vfrac.sum() * AMREX_D_TERM(geom.CellSize(0),*geom.CellSize(1),*geom.CellSize(2));
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int nspheres = 2000;
+        int npoints = 20000;
+        int n_cell = 64;
+        {
+            ParmParse pp;
+            pp.query("nspheres", nspheres);
+            pp.query("npoints", npoints);
+            pp.query("n_cell", n_cell);
+        }
+
+        // Spheres of random size and position, possibly overlapping
+        Vector<EB2::SphereIF> fs;
+        Vector<RealBox> boxes;
+        for (int n = 0; n < nspheres; ++n) {
+            const Real r = 0.01 + 0.02*amrex::Random();
+            const RealArray c{amrex::Random(), amrex::Random(), amrex::Random()};
+            fs.emplace_back(r, c, false);
+            boxes.push_back(sphereBox(c, r));
+        }
+        const auto indexed = EB2::makeIndexedUnion(fs, boxes);
+        const BruteForceUnion brute(fs);
+        AMREX_ALWAYS_ASSERT(indexed.size() == nspheres);
+
+        int nbad = 0;
+        const Real h = 0.02;
+        for (int n = 0; n < npoints; ++n) {
+            const RealArray p{amrex::Random(), amrex::Random(), amrex::Random()};
+            const Real a = indexed(p);
+            const Real b = brute(p);
+            if ((a > 0.0) != (b > 0.0) || (b >= 0.0 && a != b)) ++nbad;
+
+            const RealArray lo{p[0]-h, p[1]-h, p[2]-h};
+            const RealArray hi{p[0]+h, p[1]+h, p[2]+h};
+            const EB2::IFBounds bnd = indexed.bounds(lo, hi);
+            for (int k = 0; k < 4; ++k) {
+                const RealArray q{lo[0]+2*h*amrex::Random(), lo[1]+2*h*amrex::Random(),
+                                  lo[2]+2*h*amrex::Random()};
+                const Real v = indexed(q);
+                if (v < bnd.lo || v > bnd.hi) ++nbad;
+            }
+        }
+        ParallelDescriptor::ReduceIntSum(nbad);
+        amrex::Print() << nbad << " points with a wrong value or outside of the bounds\n";
+
+        // A lattice of spheres that do not touch
+        Vector<EB2::SphereIF> lattice;
+        Vector<RealBox> lattice_boxes;
+        const int nl = 5;
+        const Real r = 0.35/nl;
+        for (int k = 0; k < nl; ++k) {
+        for (int j = 0; j < nl; ++j) {
+        for (int i = 0; i < nl; ++i) {
+            const RealArray c{(i+0.5)/nl, (j+0.5)/nl, (k+0.5)/nl};
+            lattice.emplace_back(r, c, false);
+            lattice_boxes.push_back(sphereBox(c, r));
+        }}}
+
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({0.,0.,0.}, {1.,1.,1.});
+        Geometry geom(domain, rb, 0, {0,0,0});
+
+        EB2::Build(EB2::makeShop(EB2::makeIndexedUnion(lattice, lattice_boxes)), geom, 0, 0);
+        const Real vol_indexed = bodyVolume(geom);
+        EB2::IndexSpace::clear();
+
+        EB2::Build(EB2::makeShop(BruteForceUnion(lattice)), geom, 0, 0);
+        const Real vol_brute = bodyVolume(geom);
+        EB2::IndexSpace::clear();
+
+        const Real vol_exact = nl*nl*nl * 4./3.*M_PI*r*r*r;
+        amrex::Print() << "body volume " << vol_indexed << " indexed, " << vol_brute
+                       << " brute force, " << vol_exact << " exact\n";
+
+        if (nbad != 0 || std::abs(vol_indexed-vol_brute) > 1.e-10
+            || std::abs(vol_indexed-vol_exact) > 0.05*vol_exact)
+        {
+            amrex::Abort("IndexedUnionIF differs from the union of all of the spheres");
+        }
+        amrex::Print() << "SUCCESS\n";
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,140 @@
+#include <AMReX.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EB_levelset.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+// Moves a sphere and compares the level-set updated by LSFactory::Update with
+// the one filled again by LSFactory::Fill.  Within the band where Update
+// computes the distance from the EB facets, the two have to agree to
+// round-off.  Beyond it, Update is a first-order fast-sweeping solution, and
+// the two have to agree to within a fraction of a cell.
+
+namespace {
+
+struct MovingSphere
+{
+    MovingSphere (const LSFactory& level_set, Real radius, const RealArray& center)
+        : gshop(EB2::makeShop(EB2::SphereIF(radius, center, false)))
+    {
+        const Geometry& eb_geom = level_set.get_eb_geom();
+        EB2::Build(gshop, eb_geom, 0, 0);
+        const EB2::Level& eb_level = EB2::IndexSpace::top().getLevel(eb_geom);
+        const int eb_pad = level_set.get_eb_pad();
+        eb_factory.reset(new EBFArrayBoxFactory(eb_level, eb_geom, level_set.get_eb_ba(),
+                                                level_set.get_dm(), {eb_pad, eb_pad, eb_pad},
+                                                EBSupport::full));
+        GShopLSFactory<EB2::SphereIF> lsgs(gshop, level_set);
+        impfunc = lsgs.fill_impfunc();
+    }
+
+    EB2::GeometryShop<EB2::SphereIF> gshop;
+    std::unique_ptr<EBFArrayBoxFactory> eb_factory;
+    std::unique_ptr<MultiFab> impfunc;
+};
+
+}
+
+void main_main ()
+{
+    int n_cell, max_grid_size;
+    Real radius;
+    Vector<Real> center_0, center_1;
+    {
+        ParmParse pp;
+        pp.get("n_cell", n_cell);
+        pp.get("max_grid_size", max_grid_size);
+        pp.get("radius", radius);
+        pp.getarr("center_0", center_0);
+        pp.getarr("center_1", center_1);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Geometry geom(domain, rb, 0, {AMREX_D_DECL(0,0,0)});
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    const int ls_ref = 1, eb_ref = 1, ls_pad = 1, eb_pad = 2;
+    const RealArray c0{AMREX_D_DECL(center_0[0], center_0[1], center_0[2])};
+    const RealArray c1{AMREX_D_DECL(center_1[0], center_1[1], center_1[2])};
+
+    RealBox eb_region;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        eb_region.setLo(idim, std::min(c0[idim], c1[idim]) - radius);
+        eb_region.setHi(idim, std::max(c0[idim], c1[idim]) + radius);
+    }
+
+    bool ok = true;
+    for (int band = 1; band <= 2; ++band)
+    {
+        LSFactory ls_fill  (0, ls_ref, eb_ref, ls_pad, eb_pad, ba, geom, dm);
+        LSFactory ls_update(0, ls_ref, eb_ref, ls_pad, eb_pad, ba, geom, dm);
+
+        {
+            MovingSphere sphere(ls_fill, radius, c0);
+            ls_fill  .Fill(*sphere.eb_factory, *sphere.impfunc);
+            ls_update.Fill(*sphere.eb_factory, *sphere.impfunc);
+        }
+
+        {
+            MovingSphere sphere(ls_fill, radius, c1);
+            ls_fill  .Fill(*sphere.eb_factory, *sphere.impfunc);
+            ls_update.Update(*sphere.eb_factory, *sphere.impfunc, eb_region, band);
+        }
+
+        const MultiFab& phi_fill   = *ls_fill.get_data();
+        const MultiFab& phi_update = *ls_update.get_data();
+        const Real dx = ls_fill.get_ls_geom().CellSize(0);
+
+        Real err_band = 0.0, err_far = 0.0;
+        int nsign = 0;
+        for (MFIter mfi(phi_fill); mfi.isValid(); ++mfi)
+        {
+            auto const& a = phi_fill.const_array(mfi);
+            auto const& b = phi_update.const_array(mfi);
+            amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+            {
+                const Real e = std::abs(a(i,j,k) - b(i,j,k));
+                if (std::abs(a(i,j,k)) < band*dx) {
+                    err_band = std::max(err_band, e);
+                } else {
+                    err_far = std::max(err_far, e);
+                }
+                if (a(i,j,k)*b(i,j,k) < 0.0) ++nsign;
+            });
+        }
+        ParallelDescriptor::ReduceRealMax(err_band);
+        ParallelDescriptor::ReduceRealMax(err_far);
+        ParallelDescriptor::ReduceIntSum(nsign);
+
+        amrex::Print() << "band = " << band << ":\n"
+                       << "  Max difference within " << band << " cells of the EB: "
+                       << err_band/dx << " cells\n"
+                       << "  Max difference farther from the EB: " << err_far/dx << " cells\n"
+                       << "  Nodes with different signs: " << nsign << "\n";
+
+        ok = ok && err_band < 1.e-12*dx && err_far < 0.5*dx && nsign == 0;
+    }
+
+    if (ok) {
+        amrex::Print() << "SUCCESS\n";
+    } else {
+        amrex::Abort("LSFactory::Update does not match LSFactory::Fill");
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        main_main();
+    }
+    amrex::Finalize();
+    return 0;
+}
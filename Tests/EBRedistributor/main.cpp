@@ -0,0 +1,123 @@
+#include <AMReX.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_EBRedistributor.H>
+#include <AMReX_EB_utils.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+// Checks that EBRedistributor::apply gives the same result as
+// single_level_weighted_redistribute and single_level_redistribute, for
+// several numbers of components with the same EBRedistributor object.
+
+namespace {
+
+void fillRandom (MultiFab& mf, Real lo, Real hi)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        auto const& a = mf.array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), mf.nComp(), [&] (int i, int j, int k, int n) noexcept
+        {
+            a(i,j,k,n) = lo + (hi-lo)*amrex::Random();
+        });
+    }
+}
+
+// The data are O(1), and covered cells hold the same large value in both.
+Real maxDiff (const MultiFab& a, const MultiFab& b, int comp, int ncomp)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), ncomp, 0);
+    MultiFab::Copy(d, a, comp, 0, ncomp, 0);
+    MultiFab::Subtract(d, b, comp, 0, ncomp, 0);
+    Real r = 0.0;
+    for (int n = 0; n < ncomp; ++n) {
+        r = std::max(r, d.norm0(n));
+    }
+    return r;
+}
+
+}
+
+void main_main ()
+{
+    int n_cell, max_grid_size;
+    int ncomp = 3;
+    int ntests = 2;
+    {
+        ParmParse pp;
+        pp.get("n_cell", n_cell);
+        pp.get("max_grid_size", max_grid_size);
+        pp.query("ncomp", ncomp);
+        pp.query("ntests", ntests);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    RealBox rb({AMREX_D_DECL(0.,0.,0.)}, {AMREX_D_DECL(1.,1.,1.)});
+    Geometry geom(domain, rb, 0, {AMREX_D_DECL(0,0,0)});
+
+    EB2::SphereIF sphere(0.3, {AMREX_D_DECL(0.5,0.5,0.5)}, false);
+    auto gshop = EB2::makeShop(sphere);
+    EB2::Build(gshop, geom, 0, 0);
+
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+    auto factory = makeEBFabFactory(geom, ba, dm, {2,2,2}, EBSupport::volume);
+
+    EBRedistributor redistributor(*factory, geom);
+
+    const int ng = 2;
+    MultiFab weights(ba, dm, 1, ng, MFInfo(), *factory);
+    fillRandom(weights, 0.5, 1.5);
+
+    Real errmax = 0.0;
+    for (int itest = 0; itest < ntests; ++itest)
+    {
+        // Fewer components first, so that the scratch space of apply has to grow.
+        for (int nc = 1; nc <= ncomp; nc += std::max(ncomp-1,1))
+        {
+            const int div_comp = 1;
+            MultiFab div_tmp(ba, dm, nc, ng, MFInfo(), *factory);
+            fillRandom(div_tmp, -1.0, 1.0);
+            MultiFab div_tmp_2(ba, dm, nc, ng, MFInfo(), *factory);
+            MultiFab::Copy(div_tmp_2, div_tmp, 0, 0, nc, ng);
+
+            MultiFab div_0(ba, dm, div_comp+nc, 0, MFInfo(), *factory);
+            MultiFab div_1(ba, dm, div_comp+nc, 0, MFInfo(), *factory);
+
+            single_level_weighted_redistribute(0, div_tmp, div_0, weights, div_comp, nc, {geom});
+            redistributor.apply(div_tmp_2, div_1, weights, div_comp, nc);
+            const Real ew = maxDiff(div_0, div_1, div_comp, nc);
+
+            MultiFab::Copy(div_tmp_2, div_tmp, 0, 0, nc, ng);
+            single_level_redistribute(0, div_tmp, div_0, div_comp, nc, {geom});
+            redistributor.apply(div_tmp_2, div_1, div_comp, nc);
+            const Real eu = maxDiff(div_0, div_1, div_comp, nc);
+
+            amrex::Print() << "ncomp = " << nc << ": max difference = "
+                           << ew << " (weighted), " << eu << " (unweighted)\n";
+            errmax = std::max({errmax, ew, eu});
+        }
+    }
+
+    if (errmax < 1.e-12) {
+        amrex::Print() << "SUCCESS\n";
+    } else {
+        amrex::Abort("EBRedistributor does not match single_level_weighted_redistribute");
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        main_main();
+    }
+    amrex::Finalize();
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <AMReX.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Random.H>
+
+#include <cmath>
+#include <limits>
+
+using namespace amrex;
+
+// Reads the cube [-1,1]^3 from an ASCII STL file, scaled and translated to
+// [0.25,0.75]^3, and compares the implicit function with the exact signed
+// distance to the cube at points inside, outside and near the surface. Some
+// of the points are placed so that the first ray of the inside test grazes an
+// edge or a vertex of the cube.
+
+namespace {
+
+constexpr Real cube_lo = 0.25;
+constexpr Real cube_hi = 0.75;
+
+// The exact distance from p to the surface of the cube
+Real cubeDistance (const RealArray& p, bool& inside)
+{
+    inside = true;
+    Real dout = 0.0;
+    Real din = std::numeric_limits<Real>::max();
+    for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+        const Real d = amrex::max(cube_lo-p[i], p[i]-cube_hi, Real(0.0));
+        if (d > 0.0) inside = false;
+        dout += d*d;
+        din = amrex::min(din, p[i]-cube_lo, cube_hi-p[i]);
+    }
+    return inside ? din : std::sqrt(dout);
+}
+
+int check (const char* what, const RealArray& p, const EB2::STLIF& fluid_inside,
+           const EB2::STLIF& fluid_outside)
+{
+    const Real tol = 100.*std::numeric_limits<Real>::epsilon();
+
+    bool inside;
+    const Real d = cubeDistance(p, inside);
+    const Real f = fluid_inside(p);
+    const Real expected = inside ? -d : d;
+
+    int nbad = 0;
+    if (fluid_inside.isInside(p) != inside || std::abs(f-expected) > tol
+        || std::abs(fluid_inside.distance(p)-d) > tol
+        || fluid_outside(p) != -f)
+    {
+        ++nbad;
+        amrex::AllPrint() << what << " (" << p[0] << "," << p[1] << "," << p[2]
+                          << "): got " << f << ", expected " << expected << "\n";
+    }
+
+    const Real h = 0.01;
+    const EB2::IFBounds b = fluid_inside.bounds({p[0]-h,p[1]-h,p[2]-h},
+                                                {p[0]+h,p[1]+h,p[2]+h});
+    if (f < b.lo || f > b.hi) {
+        ++nbad;
+        amrex::AllPrint() << what << ": " << f << " is not within the bounds ["
+                          << b.lo << "," << b.hi << "]\n";
+    }
+    return nbad;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        std::string stl_file = "cube.stl";
+        int nrandom = 10000;
+        {
+            ParmParse pp;
+            pp.query("stl_file", stl_file);
+            pp.query("nrandom", nrandom);
+        }
+
+        const RealArray center{0.5, 0.5, 0.5};
+        const EB2::STLIF fluid_inside(stl_file, 0.25, center, true);
+        const EB2::STLIF fluid_outside(stl_file, 0.25, center, false);
+        AMREX_ALWAYS_ASSERT(fluid_inside.numTriangles() == 12);
+
+        RealArray lo, hi;
+        fluid_inside.boundingBox(lo, hi);
+        for (int i = 0; i < AMREX_SPACEDIM; ++i) {
+            AMREX_ALWAYS_ASSERT(lo[i] == cube_lo && hi[i] == cube_hi);
+        }
+
+        const Real h = 1.e-3;
+        int nbad = 0;
+        nbad += check("center", {0.5, 0.5, 0.5}, fluid_inside, fluid_outside);
+        nbad += check("inside", {0.3, 0.6, 0.45}, fluid_inside, fluid_outside);
+        nbad += check("just inside", {0.5, 0.5, cube_hi-h}, fluid_inside, fluid_outside);
+        nbad += check("just outside", {0.5, 0.5, cube_hi+h}, fluid_inside, fluid_outside);
+        nbad += check("just outside", {cube_lo-h, 0.4, 0.5}, fluid_inside, fluid_outside);
+        nbad += check("outside a face", {0.9, 0.5, 0.5}, fluid_inside, fluid_outside);
+        nbad += check("outside an edge", {0.9, 0.9, 0.5}, fluid_inside, fluid_outside);
+        nbad += check("outside a vertex", {0.9, 0.9, 0.9}, fluid_inside, fluid_outside);
+        nbad += check("far away", {2.0, -1.0, 2.0}, fluid_inside, fluid_outside);
+
+        // The first direction STLIF casts a ray along. The ray from p = q - s*dir
+        // goes through q.
+        const RealArray dir{0.8017, 0.4581, 0.3841};
+        auto behind = [&] (const RealArray& q, Real s) -> RealArray {
+            return {q[0]-s*dir[0], q[1]-s*dir[1], q[2]-s*dir[2]};
+        };
+        // From inside, leaving through a vertex
+        nbad += check("ray through a vertex", behind({cube_hi, cube_hi, cube_hi}, 0.2),
+                      fluid_inside, fluid_outside);
+        // From outside, touching the cube only at an edge or a vertex
+        nbad += check("ray grazing an edge", behind({cube_hi, cube_lo, 0.5}, 0.1),
+                      fluid_inside, fluid_outside);
+        nbad += check("ray grazing a vertex", behind({cube_hi, cube_lo, cube_lo}, 0.1),
+                      fluid_inside, fluid_outside);
+
+        for (int n = 0; n < nrandom; ++n) {
+            const RealArray p{amrex::Random(), amrex::Random(), amrex::Random()};
+            nbad += check("random", p, fluid_inside, fluid_outside);
+        }
+
+        ParallelDescriptor::ReduceIntSum(nbad);
+        if (nbad == 0) {
+            amrex::Print() << "SUCCESS\n";
+        } else {
+            amrex::Abort("STLIF differs from the signed distance to the cube at "
+                         + std::to_string(nbad) + " points");
+        }
+    }
+    amrex::Finalize();
+}
@@ -0,0 +1,192 @@
+#include <AMReX.H>
+#include <AMReX_EB2.H>
+#include <AMReX_EB2_IF.H>
+#include <AMReX_EBFabFactory.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_WriteEBSurface.H>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace amrex;
+
+// Writes the EB surface of a sphere with WriteEBSurfaceBinary and reads the
+// pieces back. The appended arrays have to be where the header says, with the
+// sizes it says, the offsets and the connectivity have to describe polygons of
+// 3 to 6 vertices on the sphere, all oriented the same way, and there has to be
+// one polygon per cut cell. The total area has to be close to that of the sphere.
+
+namespace {
+
+std::string readFile (const std::string& filename)
+{
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    if (!ifs.good()) amrex::FileOpenFailed(filename);
+    std::ostringstream ss;
+    ss << ifs.rdbuf();
+    return ss.str();
+}
+
+// The value of the attribute name="..." after position pos
+std::string attribute (const std::string& s, const std::string& name, std::size_t pos = 0)
+{
+    const std::size_t b = s.find(name+"=\"", pos);
+    AMREX_ALWAYS_ASSERT(b != std::string::npos);
+    const std::size_t e = s.find('"', b+name.size()+2);
+    return s.substr(b+name.size()+2, e-b-name.size()-2);
+}
+
+// The appended array at the given offset, checking the size in its header
+template <class T>
+Vector<T> appended (const std::string& s, std::size_t data, const std::string& offset,
+                    std::size_t n)
+{
+    const char* p = s.data() + data + std::stoul(offset);
+    std::uint64_t nbytes;
+    std::memcpy(&nbytes, p, sizeof(nbytes));
+    AMREX_ALWAYS_ASSERT(nbytes == n*sizeof(T));
+    AMREX_ALWAYS_ASSERT(p + sizeof(nbytes) + nbytes <= s.data() + s.size());
+    Vector<T> r(n);
+    std::memcpy(r.data(), p+sizeof(nbytes), nbytes);
+    return r;
+}
+
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc, argv);
+    {
+        int n_cell = 32;
+        int max_grid_size = 16;
+        std::string dirname = "ebsurface";
+        {
+            ParmParse pp;
+            pp.query("n_cell", n_cell);
+            pp.query("max_grid_size", max_grid_size);
+            pp.query("dirname", dirname);
+        }
+
+        // ProbLo is not zero, so the points have to be in physical coordinates
+        Box domain(IntVect(0), IntVect(n_cell-1));
+        RealBox rb({-1.,-1.,-1.}, {1.,1.,1.});
+        Geometry geom(domain, rb, 0, {0,0,0});
+        BoxArray ba(domain);
+        ba.maxSize(max_grid_size);
+        DistributionMapping dm(ba);
+
+        const Real radius = 0.5;
+        const RealArray center{0.1, -0.05, 0.2};
+        EB2::SphereIF sphere(radius, center, false);
+        EB2::Build(EB2::makeShop(sphere), geom, 0, 0);
+        EBFArrayBoxFactory factory(EB2::IndexSpace::top().getLevel(geom), geom, ba, dm,
+                                   {2,2,2}, EBSupport::full);
+
+        WriteEBSurfaceBinary(dirname, geom, factory);
+
+        // The number of cut cells
+        Long ncut = 0;
+        const auto& flags = factory.getMultiEBCellFlagFab();
+        for (MFIter mfi(flags); mfi.isValid(); ++mfi) {
+            auto const& flag = flags.const_array(mfi);
+            amrex::LoopOnCpu(mfi.validbox(), [&] (int i, int j, int k) noexcept
+            {
+                if (flag(i,j,k).isSingleValued()) ++ncut;
+            });
+        }
+        ParallelDescriptor::ReduceLongSum(ncut);
+        ParallelDescriptor::Barrier();
+
+        if (ParallelDescriptor::IOProcessor())
+        {
+            const Real dx = geom.CellSize(0);
+            const std::string index = readFile(dirname + ".pvtp");
+            Long npolys_total = 0;
+            Long npositive = 0;
+            Long nnegative = 0;
+            Real area = 0.0;
+            int npieces = 0;
+            for (std::size_t pos = index.find("<Piece "); pos != std::string::npos;
+                 pos = index.find("<Piece ", pos+1))
+            {
+                ++npieces;
+                const std::string piece = readFile(dirname + "/"
+                    + attribute(index, "Source", pos).substr(dirname.size()+1));
+
+                const Long npoints = std::stol(attribute(piece, "NumberOfPoints"));
+                const Long npolys = std::stol(attribute(piece, "NumberOfPolys"));
+                AMREX_ALWAYS_ASSERT(npolys > 0);
+
+                const std::size_t points_pos = piece.find("<Points>");
+                const std::size_t conn_pos = piece.find("Name=\"connectivity\"");
+                const std::size_t offsets_pos = piece.find("Name=\"offsets\"");
+                const std::size_t data = piece.find('_', piece.find("<AppendedData")) + 1;
+
+                const auto offsets = appended<std::int64_t>(piece, data,
+                    attribute(piece, "offset", offsets_pos), npolys);
+                const Long nconn = offsets.back();
+                const auto points = appended<float>(piece, data,
+                    attribute(piece, "offset", points_pos), 3*npoints);
+                const auto conn = appended<std::int64_t>(piece, data,
+                    attribute(piece, "offset", conn_pos), nconn);
+
+                for (Long ip = 0; ip < npolys; ++ip)
+                {
+                    const Long begin = (ip == 0) ? 0 : offsets[ip-1];
+                    const Long nv = offsets[ip] - begin;
+                    AMREX_ALWAYS_ASSERT(nv >= 3 && nv <= 6);
+
+                    // Newell's normal, whose length is twice the area
+                    RealArray normal{0.0, 0.0, 0.0};
+                    RealArray centroid{0.0, 0.0, 0.0};
+                    for (Long iv = 0; iv < nv; ++iv) {
+                        const Long a = conn[begin+iv];
+                        const Long b = conn[begin+(iv+1)%nv];
+                        AMREX_ALWAYS_ASSERT(a >= 0 && a < npoints);
+                        const float* pa = &points[3*a];
+                        const float* pb = &points[3*b];
+                        normal[0] += (pa[1]-pb[1])*(pa[2]+pb[2]);
+                        normal[1] += (pa[2]-pb[2])*(pa[0]+pb[0]);
+                        normal[2] += (pa[0]-pb[0])*(pa[1]+pb[1]);
+
+                        Real r2 = 0.0;
+                        for (int idim = 0; idim < 3; ++idim) {
+                            centroid[idim] += pa[idim] / nv;
+                            r2 += (pa[idim]-center[idim])*(pa[idim]-center[idim]);
+                        }
+                        AMREX_ALWAYS_ASSERT(std::abs(std::sqrt(r2)-radius) < 2.*dx);
+                    }
+                    area += 0.5*std::sqrt(normal[0]*normal[0] + normal[1]*normal[1]
+                                          + normal[2]*normal[2]);
+
+                    Real radial = 0.0;
+                    for (int idim = 0; idim < 3; ++idim) {
+                        radial += normal[idim]*(centroid[idim]-center[idim]);
+                    }
+                    if (radial > 0.0) ++npositive;
+                    if (radial < 0.0) ++nnegative;
+                }
+                npolys_total += npolys;
+            }
+
+            amrex::Print() << npieces << " pieces, " << npolys_total << " polygons for "
+                           << ncut << " cut cells, " << npositive << " facing out and "
+                           << nnegative << " facing in, area " << area << " vs "
+                           << 4.*M_PI*radius*radius << "\n";
+
+            // The vertices go counter-clockwise around the EB normal, which points
+            // from the fluid into the body.
+            if (npieces == 0 || npolys_total != ncut || npositive != 0 || nnegative != ncut
+                || std::abs(area - 4.*M_PI*radius*radius) > 0.02*4.*M_PI*radius*radius)
+            {
+                amrex::Abort("WriteEBSurfaceBinary wrote unexpected polygons");
+            }
+            amrex::Print() << "SUCCESS\n";
+        }
+    }
+    amrex::Finalize();
+}
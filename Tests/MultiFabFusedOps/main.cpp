@@ -0,0 +1,156 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <limits>
+
+using namespace amrex;
+
+// Compares the fused MultiFab operations (LinComb of three MultiFabs,
+// LinCombNorm0 and Dot with several MultiFabs) with the same computation
+// done by the separate operations, with and without ghost cells and with
+// the destination aliasing a source.
+
+namespace {
+
+void fillRandom (MultiFab& mf)
+{
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi)
+    {
+        auto const& a = mf.array(mfi);
+        amrex::LoopOnCpu(mfi.fabbox(), mf.nComp(), [&] (int i, int j, int k, int n) noexcept
+        {
+            a(i,j,k,n) = 2.0*amrex::Random() - 1.0;
+        });
+    }
+}
+
+// Max difference of a and b, including ghost cells
+Real maxDiff (const MultiFab& a, const MultiFab& b)
+{
+    MultiFab d(a.boxArray(), a.DistributionMap(), a.nComp(), a.nGrow());
+    MultiFab::Copy(d, a, 0, 0, a.nComp(), a.nGrow());
+    MultiFab::Subtract(d, b, 0, 0, a.nComp(), a.nGrow());
+    Real r = 0.0;
+    for (int n = 0; n < a.nComp(); ++n) {
+        r = std::max(r, d.norm0(n, d.nGrow()));
+    }
+    return r;
+}
+
+Real relDiff (Real a, Real b)
+{
+    return std::abs(a-b) / std::max(std::abs(b), std::numeric_limits<Real>::min());
+}
+
+}
+
+void main_main ()
+{
+    int n_cell, max_grid_size;
+    {
+        ParmParse pp;
+        pp.get("n_cell", n_cell);
+        pp.get("max_grid_size", max_grid_size);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    const int ncomp = 3;
+    const int ngx = 2;
+    MultiFab x(ba, dm, ncomp, ngx);
+    MultiFab y(ba, dm, ncomp, ngx);
+    MultiFab z(ba, dm, ncomp, ngx);
+    fillRandom(x);
+    fillRandom(y);
+    fillRandom(z);
+
+    const Real a = 0.7, b = -1.3, c = 2.1;
+    Real errmax = 0.0;
+    auto report = [&] (const std::string& name, Real e)
+    {
+        amrex::Print() << name << ": " << e << "\n";
+        errmax = std::max(errmax, e);
+    };
+
+    for (int nghost = 0; nghost <= 1; ++nghost)
+    {
+        const std::string ng = " (nghost = " + std::to_string(nghost) + ")";
+
+        // Three-term LinComb on components 1 and 2
+        {
+            MultiFab d0(ba, dm, ncomp, nghost);
+            MultiFab d1(ba, dm, ncomp, nghost);
+            d0.setVal(0.0);
+            d1.setVal(0.0);
+            MultiFab::LinComb(d0, a, x, 1, b, y, 1, 1, 2, nghost);
+            MultiFab::Saxpy(d0, c, z, 1, 1, 2, nghost);
+            MultiFab::LinComb(d1, a, x, 1, b, y, 1, c, z, 1, 1, 2, nghost);
+            report("LinComb with three MultiFabs, max diff" + ng, maxDiff(d0, d1));
+        }
+
+        // Three-term LinComb into one of its sources, as in BiCGStab
+        {
+            MultiFab d0(ba, dm, ncomp, ngx);
+            MultiFab d1(ba, dm, ncomp, ngx);
+            MultiFab::Copy(d0, y, 0, 0, ncomp, ngx);
+            MultiFab::Copy(d1, y, 0, 0, ncomp, ngx);
+            MultiFab::LinComb(d0, b, d0, 0, a, x, 0, 0, ncomp, nghost);
+            MultiFab::Saxpy(d0, c, z, 0, 0, ncomp, nghost);
+            MultiFab::LinComb(d1, b, d1, 0, a, x, 0, c, z, 0, 0, ncomp, nghost);
+            report("LinComb with three MultiFabs in place, max diff" + ng, maxDiff(d0, d1));
+        }
+
+        // LinCombNorm0 into a new MultiFab and in place
+        for (int inplace = 0; inplace <= 1; ++inplace)
+        {
+            MultiFab d0(ba, dm, ncomp, ngx);
+            MultiFab d1(ba, dm, ncomp, ngx);
+            MultiFab::Copy(d0, x, 0, 0, ncomp, ngx);
+            MultiFab::Copy(d1, x, 0, 0, ncomp, ngx);
+            const MultiFab& src0 = (inplace) ? d0 : z;
+            const MultiFab& src1 = (inplace) ? d1 : z;
+            MultiFab::LinComb(d0, a, src0, 0, b, y, 0, 0, ncomp, nghost);
+            Real nrm0 = 0.0;
+            for (int n = 0; n < ncomp; ++n) {
+                nrm0 = std::max(nrm0, d0.norm0(n));
+            }
+            const Real nrm1 = MultiFab::LinCombNorm0(d1, a, src1, 0, b, y, 0, 0, ncomp, nghost);
+            const std::string what = (inplace) ? " in place" : "";
+            report("LinCombNorm0" + what + ", max diff" + ng, maxDiff(d0, d1));
+            report("LinCombNorm0" + what + ", norm rel diff" + ng, relDiff(nrm1, nrm0));
+        }
+
+        // Dot of x with several MultiFabs, on components 1 and 2
+        {
+            const Vector<MultiFab const*> ys{&y, &z, &x};
+            const Vector<Real> dots = MultiFab::Dot(x, 1, ys, 1, 2, nghost);
+            AMREX_ALWAYS_ASSERT(dots.size() == ys.size());
+            Real e = 0.0;
+            for (int i = 0, N = ys.size(); i < N; ++i) {
+                e = std::max(e, relDiff(dots[i], MultiFab::Dot(x, 1, *ys[i], 1, 2, nghost)));
+            }
+            report("Dot with several MultiFabs, max rel diff" + ng, e);
+        }
+    }
+
+    if (errmax < 1.e-12) {
+        amrex::Print() << "SUCCESS\n";
+    } else {
+        amrex::Abort("The fused MultiFab operations do not match the separate ones");
+    }
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        main_main();
+    }
+    amrex::Finalize();
+    return 0;
+}
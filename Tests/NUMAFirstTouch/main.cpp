@@ -0,0 +1,121 @@
+#include <AMReX.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+using namespace amrex;
+
+// Measures the bandwidth of a triad over tiles on OpenMP threads, with the
+// data placed by the master thread and with fabarray.numa_first_touch.  Run
+// with one rank per node and OMP_PROC_BIND=true to see the difference on a
+// multi-socket node.
+
+namespace {
+
+struct TriadData
+{
+    TriadData (const BoxArray& ba, const DistributionMapping& dm, int nvar, bool first_touch)
+    {
+        FabArrayBase::numa_first_touch = first_touch;
+        a.define(ba, dm, nvar, 0);
+        b.define(ba, dm, nvar, 0);
+        c.define(ba, dm, nvar, 0);
+        FabArrayBase::numa_first_touch = false;
+
+        // Initialize the data on the master thread.  Without first touch, this
+        // places all the pages on the master thread's NUMA node.
+        for (MFIter mfi(a); mfi.isValid(); ++mfi)
+        {
+            a[mfi].setVal<RunOn::Host>(0.0);
+            b[mfi].setVal<RunOn::Host>(1.0);
+            c[mfi].setVal<RunOn::Host>(2.0);
+        }
+    }
+
+    MultiFab a, b, c;
+};
+
+Real triad (TriadData& d, int nsteps)
+{
+    const int nvar = d.a.nComp();
+    const Real scal = 3.0;
+
+    Real strt_time = ParallelDescriptor::second();
+
+    for (int s = 0; s < nsteps; ++s)
+    {
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(d.a, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.tilebox();
+            auto const& a = d.a.array(mfi);
+            auto const& b = d.b.const_array(mfi);
+            auto const& c = d.c.const_array(mfi);
+            amrex::ParallelFor(bx, nvar,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                a(i,j,k,n) = b(i,j,k,n) + scal * c(i,j,k,n);
+            });
+        }
+    }
+
+    Real run_time = ParallelDescriptor::second() - strt_time;
+    ParallelDescriptor::ReduceRealMax(run_time);
+
+    const Real nbytes = 3.0 * nvar * d.a.boxArray().numPts() * sizeof(Real);
+    return nbytes / (run_time / nsteps) / (1024.0*1024.0*1024.0);
+}
+
+}
+
+void main_main ()
+{
+    int n_cell, max_grid_size, nsteps, nvar;
+    {
+        ParmParse pp;
+
+        // Number of cells on each side of a cubic domain.
+        pp.get("n_cell", n_cell);
+
+        // The domain is broken into boxes of size max_grid_size
+        pp.get("max_grid_size", max_grid_size);
+
+        nsteps = 20;
+        pp.query("nsteps", nsteps);
+
+        nvar = 1;
+        pp.query("nvar", nvar);
+    }
+
+    Box domain(IntVect(0), IntVect(n_cell-1));
+    BoxArray ba(domain);
+    ba.maxSize(max_grid_size);
+    DistributionMapping dm(ba);
+
+    // Both sets of data are allocated before either is freed, so that the
+    // second one does not reuse pages of the first one.
+    TriadData master(ba, dm, nvar, false);
+    TriadData touch (ba, dm, nvar, true);
+
+    const Real bw_master = triad(master, nsteps);
+    const Real bw_touch  = triad(touch, nsteps);
+
+    amrex::Print() << "n_cell = " << n_cell << ", max_grid_size = " << max_grid_size
+                   << ", nvar = " << nvar << ", nsteps = " << nsteps << "\n"
+                   << "Bandwidth with data placed by the master thread = "
+                   << bw_master << " GB/s\n"
+                   << "Bandwidth with fabarray.numa_first_touch        = "
+                   << bw_touch << " GB/s\n";
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        main_main();
+    }
+    amrex::Finalize();
+    return 0;
+}
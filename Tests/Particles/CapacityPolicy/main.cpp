@@ -0,0 +1,155 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Particles.H>
+
+using namespace amrex;
+
+// Puts a clump of particles into every box, removes most of them, and checks
+// that Redistribute gives the tile memory back according to the capacity
+// policy, without shrinking again on the next Redistribute. Also checks that
+// the ParticleMemoryCounter follows the containers through moves and
+// destruction, and that PODVector::shrink_to never grows a buffer.
+
+static constexpr int NSR = 1;
+static constexpr int NSI = 0;
+static constexpr int NAR = 2;
+static constexpr int NAI = 0;
+
+using PC = ParticleContainer<NSR, NSI, NAR, NAI>;
+
+struct TestParams
+{
+    int ncell;
+    int max_grid_size;
+    int nclump;
+};
+
+bool testShrinkTo ()
+{
+    Gpu::HostVector<int> v(100);
+    v.reserve(1000);
+    bool ok = v.capacity() == 1000;
+    v.shrink_to(500);
+    ok = ok && v.capacity() == 500 && v.size() == 100;
+    v.shrink_to(2000);
+    ok = ok && v.capacity() == 500;
+    v.shrink_to(10);
+    ok = ok && v.capacity() == 100 && v.size() == 100;
+    return ok;
+}
+
+void InitClumps (PC& pc, int nclump)
+{
+    const Real* dx = pc.Geom(0).CellSize();
+    const Real* plo = pc.Geom(0).ProbLo();
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& ptile = pc.DefineAndReturnParticleTile(0, mfi.index(), mfi.LocalTileIndex());
+        const Box& bx = mfi.tilebox();
+        const IntVect& iv = bx.smallEnd();
+        for (int n = 0; n < nclump; ++n) {
+            PC::ParticleType p;
+            p.id()  = PC::ParticleType::NextID();
+            p.cpu() = ParallelDescriptor::MyProc();
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                p.pos(d) = plo[d] + (iv[d] + amrex::Random())*dx[d];
+            }
+            p.rdata(0) = 1.0;
+            ptile.push_back(p);
+            ptile.push_back_real(0, 1.0);
+            ptile.push_back_real(1, 2.0);
+        }
+    }
+    pc.Redistribute();
+}
+
+// Is the capacity of every tile between its live bytes and the threshold?
+bool tilesWithinThreshold (PC& pc, Real threshold)
+{
+    bool ok = true;
+    for (const auto& kv : pc.GetParticles(0)) {
+        const long cap = kv.second.capacity();
+        const long used = kv.second.nbytes();
+        ok = ok && cap >= used && cap <= threshold*used;
+    }
+    ParallelDescriptor::ReduceBoolAnd(ok);
+    return ok;
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        TestParams params;
+        Real threshold = 2.0;
+        {
+            ParmParse pp;
+            pp.get("ncell", params.ncell);
+            pp.get("max_grid_size", params.max_grid_size);
+            pp.get("nclump", params.nclump);
+            ParmParse pp_particles("particles");
+            pp_particles.get("capacity_shrink_threshold", threshold);
+        }
+
+        bool ok = testShrinkTo();
+        amrex::Print() << "PODVector::shrink_to: " << ok << "\n";
+
+        RealBox real_box;
+        for (int n = 0; n < AMREX_SPACEDIM; n++) {
+            real_box.setLo(n, 0.0);
+            real_box.setHi(n, 1.0);
+        }
+        const Box domain(IntVect::TheZeroVector(), IntVect(params.ncell-1));
+        Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,1,1)};
+        Geometry geom(domain, &real_box, CoordSys::cartesian, is_per.data());
+
+        BoxArray ba(domain);
+        ba.maxSize(params.max_grid_size);
+        DistributionMapping dm(ba);
+
+        {
+            PC pc(geom, dm, ba);
+            InitClumps(pc, params.nclump);
+            const long cap_clump = pc.CapacityBytes();
+            const bool counted = ParticleMemoryCounter::totalBytes() == cap_clump
+                && ParticleMemoryCounter::totalBytesHWM() >= cap_clump;
+
+            // Keep every tenth particle
+            for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+                auto& aos = pti.GetArrayOfStructs();
+                for (int i = 0; i < aos.numParticles(); ++i) {
+                    if (i % 10 != 0) aos[i].id() = -1;
+                }
+            }
+            pc.Redistribute();
+            const long cap_shrunk = pc.CapacityBytes();
+            const bool shrunk = cap_shrunk < cap_clump/4 && tilesWithinThreshold(pc, threshold)
+                && ParticleMemoryCounter::totalBytes() == cap_shrunk
+                && ParticleMemoryCounter::totalBytesHWM() >= cap_clump;
+
+            // A second Redistribute must not shrink the tiles again
+            pc.Redistribute();
+            const bool stable = pc.CapacityBytes() == cap_shrunk;
+
+            // The bytes move with the container
+            PC pc2(std::move(pc));
+            const bool moved = ParticleMemoryCounter::totalBytes() == cap_shrunk;
+
+            amrex::Print() << "counted " << counted << ", shrunk " << shrunk << ", stable "
+                           << stable << ", moved " << moved << "\n";
+            ok = ok && counted && shrunk && stable && moved;
+        }
+
+        // and are removed when it is destroyed
+        const bool released = ParticleMemoryCounter::totalBytes() == 0;
+        amrex::Print() << "released " << released << "\n";
+        ok = ok && released;
+
+        ParallelDescriptor::ReduceBoolAnd(ok);
+        if (!ok) {
+            amrex::Abort("The particle capacity policy did not behave as expected");
+        }
+        amrex::Print() << "SUCCESS\n";
+    }
+    amrex::Finalize();
+}
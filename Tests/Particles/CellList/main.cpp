@@ -0,0 +1,161 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_NeighborParticles.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+// Builds the cell list of every tile over its particles and its neighbors, and
+// checks that the sorted data are those of the particles they come from, and
+// that the neighbor spans of the bin of every particle hold all of the partners
+// within one cell size, found by comparing every particle with every other.
+
+static constexpr int NSR = 2;
+static constexpr int NSI = 0;
+
+using PC = NeighborParticleContainer<NSR, NSI>;
+
+struct TestParams
+{
+    IntVect size;
+    int max_grid_size;
+    int num_ppc;
+};
+
+void InitParticles (PC& pc, int num_ppc)
+{
+    const Real* dx = pc.Geom(0).CellSize();
+    const Real* plo = pc.Geom(0).ProbLo();
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& tile = pc.GetParticles(0)[std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        const Box& bx = mfi.tilebox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < num_ppc; ++n) {
+                PC::ParticleType p;
+                p.id()  = PC::ParticleType::NextID();
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + amrex::Random())*dx[d];
+                }
+                p.rdata(0) = p.id();
+                p.rdata(1) = p.cpu();
+                tile.push_back(p);
+            }
+        }
+    }
+    pc.Redistribute();
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        TestParams params;
+        {
+            ParmParse pp("cell_list");
+            pp.get("size", params.size);
+            pp.get("max_grid_size", params.max_grid_size);
+            pp.get("num_ppc", params.num_ppc);
+        }
+
+        RealBox real_box;
+        for (int n = 0; n < AMREX_SPACEDIM; n++) {
+            real_box.setLo(n, 0.0);
+            real_box.setHi(n, params.size[n]);
+        }
+        const Box domain(IntVect(AMREX_D_DECL(0,0,0)), params.size - 1);
+        Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,1,1)};
+        Geometry geom(domain, &real_box, 0, is_per.data());
+
+        BoxArray ba(domain);
+        ba.maxSize(params.max_grid_size);
+        DistributionMapping dm(ba);
+
+        PC pc(geom, dm, ba, 1);
+        InitParticles(pc, params.num_ppc);
+        pc.fillNeighbors();
+        pc.buildCellList();
+
+        const Real cutoff2 = geom.CellSize(0)*geom.CellSize(0);
+        auto dist2 = [] (const PC::ParticleType& a, const PC::ParticleType& b) -> Real
+        {
+            Real r2 = 0.0;
+            for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                r2 += (a.pos(dir)-b.pos(dir))*(a.pos(dir)-b.pos(dir));
+            }
+            return r2;
+        };
+
+        Long nwrong_data = 0;
+        Long nwrong_pairs = 0;
+        Long npairs = 0;
+        for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+        {
+            const int grid = mfi.index();
+            const int tile = mfi.LocalTileIndex();
+            const auto& aos = pc.GetParticles(0)[std::make_pair(grid, tile)].GetArrayOfStructs();
+            const auto& nbors = pc.GetNeighbors(0, grid, tile);
+            Vector<PC::ParticleType> all(aos().begin(), aos().end());
+            all.insert(all.end(), nbors.begin(), nbors.end());
+            const int np = aos.numParticles();
+
+            const auto& cl = pc.GetCellList(0, grid, tile);
+            const auto d = cl.data();
+            AMREX_ALWAYS_ASSERT(d.numParticles() == all.size());
+
+            // The sorted data, and the bin of every sorted particle
+            Vector<int> sorted_of(all.size(), -1);
+            Vector<int> bin_of(all.size(), -1);
+            for (int b = 0; b < d.numBins(); ++b) {
+                for (auto j = d.binBegin(b); j < d.binEnd(b); ++j) {
+                    const auto& p = all[d.index(j)];
+                    for (int dir = 0; dir < AMREX_SPACEDIM; ++dir) {
+                        if (d.pos(dir)[j] != p.pos(dir)) ++nwrong_data;
+                    }
+                    for (int comp = 0; comp < NSR; ++comp) {
+                        if (d.rdata(comp)[j] != p.rdata(comp)) ++nwrong_data;
+                    }
+                    sorted_of[d.index(j)] = j;
+                    bin_of[d.index(j)] = b;
+                }
+            }
+            if (std::count(sorted_of.begin(), sorted_of.end(), -1) != 0) ++nwrong_data;
+
+            for (int i = 0; i < np; ++i)
+            {
+                const auto si = static_cast<unsigned int>(sorted_of[i]);
+                Vector<int> from_spans;
+                for (int n = 0; n < d.numNeighborSpans(); ++n) {
+                    const CellSpan s = d.neighborSpan(bin_of[i], n);
+                    for (auto j = s.begin; j < s.end; ++j) {
+                        if (j != si && dist2(all[i], all[d.index(j)]) <= cutoff2) {
+                            from_spans.push_back(d.index(j));
+                        }
+                    }
+                }
+                Vector<int> from_all;
+                for (int j = 0; j < static_cast<int>(all.size()); ++j) {
+                    if (j != i && dist2(all[i], all[j]) <= cutoff2) from_all.push_back(j);
+                }
+                std::sort(from_spans.begin(), from_spans.end());
+                if (from_spans != from_all) ++nwrong_pairs;
+                npairs += from_all.size();
+            }
+        }
+
+        ParallelDescriptor::ReduceLongSum(nwrong_data);
+        ParallelDescriptor::ReduceLongSum(nwrong_pairs);
+        ParallelDescriptor::ReduceLongSum(npairs);
+
+        amrex::Print() << npairs << " pairs, " << nwrong_data << " wrong data, "
+                       << nwrong_pairs << " particles with wrong partners\n";
+
+        if (npairs == 0 || nwrong_data != 0 || nwrong_pairs != 0) {
+            amrex::Abort("The cell list does not match the particles");
+        }
+        amrex::Print() << "SUCCESS\n";
+    }
+    amrex::Finalize();
+}
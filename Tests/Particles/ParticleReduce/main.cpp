@@ -212,5 +212,25 @@ void testReduce ()
         AMREX_ALWAYS_ASSERT(r == 0);
     }
 
+    {
+        const int nbins = params.size[0];
+        auto h = amrex::ParticleHistogram(pc, 0.0, params.size[0], nbins,
+            [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real { return p.pos(0); },
+            [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real { return p.rdata(1); });
+        const Real per_bin = Real(pc.TotalNumberOfParticles()) / nbins;
+        for (int b = 0; b < nbins; ++b) AMREX_ALWAYS_ASSERT(h[b] == per_bin);
+    }
+
+    {
+        const int nx = params.size[0];
+        const int ny = params.size[1];
+        auto h = amrex::ParticleHistogram2D(pc, 0.0, params.size[0], nx, 0.0, params.size[1], ny,
+            [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> GpuArray<Real,2>
+            { return {p.pos(0), p.pos(1)}; },
+            [=] AMREX_GPU_HOST_DEVICE (const PType&) -> Real { return 1.0; });
+        const Real per_bin = Real(pc.TotalNumberOfParticles()) / (nx*ny);
+        for (int b = 0; b < nx*ny; ++b) AMREX_ALWAYS_ASSERT(h[b] == per_bin);
+    }
+
     amrex::Print() << "pass \n";
 }
@@ -0,0 +1,203 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_Particles.H>
+#include <AMReX_ParticleMesh.H>
+
+#include <cmath>
+
+using namespace amrex;
+
+// Checks the built-in shapes of DepositToMesh and InterpolateFromMesh:
+//  - the weights of every shape add up to one and reproduce linear functions,
+//  - the deposition conserves the total of every component, and gives the same
+//    mesh as a plain ParticleToMesh with atomics,
+//  - the interpolation of a linear field, cell-centered or nodal, is exact at
+//    the particles that are far enough from the periodic boundaries.
+
+struct TestParams
+{
+    int ncell;
+    int max_grid_size;
+    int nppc;
+};
+
+using PC = ParticleContainer<3>;
+
+// The linear field that is interpolated
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+Real linearField (Real x, Real y, Real z) noexcept
+{
+    return 1.0 + 2.0*x - 3.0*y + 0.5*z;
+}
+
+template <class Shape>
+bool testWeights ()
+{
+    bool ok = true;
+    for (int n = 0; n < 1000; ++n) {
+        const Real x = 10.0*amrex::Random();
+        Real w[Shape::width];
+        const int i0 = Shape::eval(x, w);
+        Real sum = 0.0;
+        Real first = 0.0;
+        for (int k = 0; k < Shape::width; ++k) {
+            ok = ok && w[k] >= 0.0;
+            sum += w[k];
+            first += w[k]*(i0+k);
+        }
+        ok = ok && std::abs(sum-1.0) < 1.e-12 && std::abs(first-x) < 1.e-12;
+    }
+    return ok;
+}
+
+template <class Shape>
+bool testDeposit (PC& pc, const Geometry& geom, const BoxArray& ba,
+                  const DistributionMapping& dm)
+{
+    auto values = [=] AMREX_GPU_HOST_DEVICE (const PC::ParticleType& p) -> GpuArray<Real,2>
+    {
+        return {p.rdata(0), p.rdata(0)*p.rdata(1)};
+    };
+
+    MultiFab mf(ba, dm, 2, Shape::nghost);
+    DepositToMesh<Shape,2>(pc, mf, 0, 0, values);
+
+    const auto plo = geom.ProbLoArray();
+    const auto dxi = geom.InvCellSizeArray();
+    MultiFab ref(ba, dm, 2, Shape::nghost);
+    ParticleToMesh(pc, ref, 0,
+        [=] AMREX_GPU_DEVICE (const PC::ParticleType& p, Array4<Real> const& arr)
+        {
+            GpuArray<Real,AMREX_SPACEDIM> x;
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) x[d] = (p.pos(d)-plo[d])*dxi[d] - 0.5;
+            particle_deposit<Shape,2,true>(x, arr, 0, values(p));
+        });
+
+    Real total[2] = {0.0, 0.0};
+    for (PC::ParConstIterType pti(pc, 0); pti.isValid(); ++pti) {
+        for (const auto& p : pti.GetArrayOfStructs()) {
+            const auto v = values(p);
+            total[0] += v[0];
+            total[1] += v[1];
+        }
+    }
+    ParallelDescriptor::ReduceRealSum(total, 2);
+
+    bool ok = true;
+    for (int comp = 0; comp < 2; ++comp) {
+        ok = ok && std::abs(mf.sum(comp) - total[comp]) < 1.e-10*std::abs(total[comp]);
+    }
+    MultiFab::Subtract(ref, mf, 0, 0, 2, 0);
+    ok = ok && ref.norm0(0) < 1.e-12*mf.norm0(0) && ref.norm0(1) < 1.e-12*mf.norm0(1);
+    return ok;
+}
+
+template <class Shape>
+bool testInterpolate (PC& pc, const Geometry& geom, const BoxArray& ba,
+                      const DistributionMapping& dm, const IntVect& nodal)
+{
+    const auto plo = geom.ProbLoArray();
+    const auto dx = geom.CellSizeArray();
+
+    MultiFab mf(amrex::convert(ba, nodal), dm, 1, Shape::nghost);
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        auto const& arr = mf.array(mfi);
+        const Real sx = nodal[0] ? 0.0 : 0.5;
+        const Real sy = nodal[1] ? 0.0 : 0.5;
+        const Real sz = nodal[2] ? 0.0 : 0.5;
+        amrex::ParallelFor(mfi.fabbox(), [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            arr(i,j,k) = linearField(plo[0]+(i+sx)*dx[0], plo[1]+(j+sy)*dx[1],
+                                     plo[2]+(k+sz)*dx[2]);
+        });
+    }
+
+    InterpolateFromMesh<Shape,1>(pc, mf, 0, 0,
+        [=] AMREX_GPU_HOST_DEVICE (PC::ParticleType& p, GpuArray<Real,1> const& v)
+        {
+            p.rdata(2) = v[0];
+        });
+
+    // The field is not periodic, so only particles whose stencil stays inside of
+    // the domain see a linear field.
+    const Real margin = 3.0*dx[0];
+    const auto phi = geom.ProbHiArray();
+    Long nwrong = 0;
+    for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+        for (const auto& p : pti.GetArrayOfStructs()) {
+            bool inside = true;
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                inside = inside && p.pos(d) > plo[d]+margin && p.pos(d) < phi[d]-margin;
+            }
+            const Real exact = linearField(p.pos(0), p.pos(1), p.pos(2));
+            if (inside && std::abs(p.rdata(2) - exact) > 1.e-10) ++nwrong;
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(nwrong);
+    return nwrong == 0;
+}
+
+template <class Shape>
+bool testShape (const char* name, PC& pc, const Geometry& geom, const BoxArray& ba,
+                const DistributionMapping& dm)
+{
+    bool weights = testWeights<Shape>();
+    ParallelDescriptor::ReduceBoolAnd(weights);
+    const bool deposit = testDeposit<Shape>(pc, geom, ba, dm);
+    const bool cell = testInterpolate<Shape>(pc, geom, ba, dm, IntVect::TheZeroVector());
+    const bool node = testInterpolate<Shape>(pc, geom, ba, dm, IntVect::TheUnitVector());
+    amrex::Print() << name << ": weights " << weights << ", deposit " << deposit
+                   << ", cell-centered interpolation " << cell
+                   << ", nodal interpolation " << node << "\n";
+    return weights && deposit && cell && node;
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        TestParams params;
+        {
+            ParmParse pp;
+            pp.get("ncell", params.ncell);
+            pp.get("max_grid_size", params.max_grid_size);
+            pp.get("nppc", params.nppc);
+        }
+
+        RealBox real_box;
+        for (int n = 0; n < AMREX_SPACEDIM; n++) {
+            real_box.setLo(n, -0.5);
+            real_box.setHi(n, 1.5);
+        }
+        const Box domain(IntVect::TheZeroVector(), IntVect(params.ncell-1));
+        Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,1,1)};
+        Geometry geom(domain, &real_box, CoordSys::cartesian, is_per.data());
+
+        BoxArray ba(domain);
+        ba.maxSize(params.max_grid_size);
+        DistributionMapping dm(ba);
+
+        PC pc(geom, dm, ba);
+        PC::ParticleInitData pdata = {2.0, 3.0, 0.0};
+        pc.InitRandom(params.nppc*domain.numPts(), 451, pdata, true);
+        // Give the particles different masses and velocities
+        for (PC::ParIterType pti(pc, 0); pti.isValid(); ++pti) {
+            for (auto& p : pti.GetArrayOfStructs()) {
+                p.rdata(0) *= 0.5 + amrex::Random();
+                p.rdata(1) *= amrex::Random() - 0.5;
+            }
+        }
+
+        bool ok = true;
+        ok = testShape<ParticleShape::CIC>("CIC", pc, geom, ba, dm) && ok;
+        ok = testShape<ParticleShape::TSC>("TSC", pc, geom, ba, dm) && ok;
+        ok = testShape<ParticleShape::CubicSpline>("cubic spline", pc, geom, ba, dm) && ok;
+
+        if (!ok) {
+            amrex::Abort("The particle shapes do not deposit or interpolate as expected");
+        }
+        amrex::Print() << "SUCCESS\n";
+    }
+    amrex::Finalize();
+}
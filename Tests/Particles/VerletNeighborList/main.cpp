@@ -0,0 +1,176 @@
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_NeighborParticles.H>
+
+using namespace amrex;
+
+// Moves particles by small random steps and keeps their neighbor list with
+// updateNeighborListVerlet. After every step, the pairs in the list that are
+// within the interaction range have to be all of the pairs within that range,
+// found by comparing every particle with every other, and the list must have
+// been reused for some of the steps.
+
+static constexpr int NSR = 1;
+static constexpr int NSI = 0;
+
+using PC = NeighborParticleContainer<NSR, NSI>;
+
+struct TestParams
+{
+    IntVect size;
+    int max_grid_size;
+    int num_ppc;
+    int nsteps;
+    Real cutoff;
+    Real skin;
+    Real max_step;
+};
+
+struct CheckPair
+{
+    Real cutoff;
+
+    template <class P>
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    bool operator() (const P& p1, const P& p2) const
+    {
+        Real d0 = p1.pos(0) - p2.pos(0);
+        Real d1 = p1.pos(1) - p2.pos(1);
+        Real d2 = p1.pos(2) - p2.pos(2);
+        return d0*d0 + d1*d1 + d2*d2 <= cutoff*cutoff;
+    }
+};
+
+void InitParticles (PC& pc, int num_ppc)
+{
+    const Real* dx = pc.Geom(0).CellSize();
+    const Real* plo = pc.Geom(0).ProbLo();
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& tile = pc.GetParticles(0)[std::make_pair(mfi.index(), mfi.LocalTileIndex())];
+        const Box& bx = mfi.tilebox();
+        for (IntVect iv = bx.smallEnd(); iv <= bx.bigEnd(); bx.next(iv)) {
+            for (int n = 0; n < num_ppc; ++n) {
+                PC::ParticleType p;
+                p.id()  = PC::ParticleType::NextID();
+                p.cpu() = ParallelDescriptor::MyProc();
+                for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                    p.pos(d) = plo[d] + (iv[d] + amrex::Random())*dx[d];
+                }
+                p.rdata(0) = 0.0;
+                tile.push_back(p);
+            }
+        }
+    }
+    pc.Redistribute();
+}
+
+void MoveParticles (PC& pc, Real max_step)
+{
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        auto& aos = pc.GetParticles(0)[std::make_pair(mfi.index(), mfi.LocalTileIndex())]
+            .GetArrayOfStructs();
+        for (auto& p : aos) {
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                p.pos(d) += max_step*(2.0*amrex::Random()-1.0);
+            }
+        }
+    }
+}
+
+// The number of pairs within the cutoff that are missing from the list
+Long CheckNeighborList (PC& pc, Real cutoff)
+{
+    CheckPair within{cutoff};
+    Long nmissing = 0;
+    for (MFIter mfi = pc.MakeMFIter(0); mfi.isValid(); ++mfi)
+    {
+        const int grid = mfi.index();
+        const int tile = mfi.LocalTileIndex();
+        const auto& aos = pc.GetParticles(0)[std::make_pair(grid, tile)].GetArrayOfStructs();
+        const auto& nbors = pc.GetNeighbors(0, grid, tile);
+        const auto& nl = pc.GetNeighborList(0, grid, tile);
+
+        Vector<PC::ParticleType> all(aos().begin(), aos().end());
+        all.insert(all.end(), nbors.begin(), nbors.end());
+
+        const int np = aos.numParticles();
+        int start = 0;
+        for (int i = 0; i < np; ++i)
+        {
+            AMREX_ALWAYS_ASSERT(start < static_cast<int>(nl.size()));
+            const int nn = nl[start];
+            int nlisted = 0;
+            for (int k = start+1; k <= start+nn; ++k) {
+                const int j = nl[k]-1;
+                AMREX_ALWAYS_ASSERT(j >= 0 && j < static_cast<int>(all.size()) && j != i);
+                if (within(all[i], all[j])) ++nlisted;
+            }
+            int nall = 0;
+            for (int j = 0; j < static_cast<int>(all.size()); ++j) {
+                if (j != i && within(all[i], all[j])) ++nall;
+            }
+            nmissing += nall - nlisted;
+            start += nn+1;
+        }
+    }
+    ParallelDescriptor::ReduceLongSum(nmissing);
+    return nmissing;
+}
+
+int main (int argc, char* argv[])
+{
+    amrex::Initialize(argc,argv);
+    {
+        TestParams params;
+        {
+            ParmParse pp("verlet");
+            pp.get("size", params.size);
+            pp.get("max_grid_size", params.max_grid_size);
+            pp.get("num_ppc", params.num_ppc);
+            pp.get("nsteps", params.nsteps);
+            pp.get("cutoff", params.cutoff);
+            pp.get("skin", params.skin);
+            pp.get("max_step", params.max_step);
+        }
+
+        RealBox real_box;
+        for (int n = 0; n < AMREX_SPACEDIM; n++) {
+            real_box.setLo(n, 0.0);
+            real_box.setHi(n, params.size[n]);
+        }
+        const Box domain(IntVect(AMREX_D_DECL(0,0,0)), params.size - 1);
+        Array<int,AMREX_SPACEDIM> is_per{AMREX_D_DECL(1,1,1)};
+        Geometry geom(domain, &real_box, 0, is_per.data());
+
+        BoxArray ba(domain);
+        ba.maxSize(params.max_grid_size);
+        DistributionMapping dm(ba);
+
+        // The list and the neighbor buffers cover the cutoff plus the skin
+        AMREX_ALWAYS_ASSERT(params.cutoff + params.skin <= geom.CellSize(0));
+        PC pc(geom, dm, ba, 1);
+        InitParticles(pc, params.num_ppc);
+        pc.setVerletSkin(params.skin);
+
+        const CheckPair check_pair{params.cutoff + params.skin};
+        int nbuilds = 0;
+        Long nmissing = 0;
+        for (int step = 0; step < params.nsteps; ++step)
+        {
+            if (pc.updateNeighborListVerlet(check_pair)) ++nbuilds;
+            nmissing += CheckNeighborList(pc, params.cutoff);
+            MoveParticles(pc, params.max_step);
+        }
+
+        amrex::Print() << "The list was built " << nbuilds << " times in " << params.nsteps
+                       << " steps, " << nmissing << " pairs were missing\n";
+
+        if (nmissing != 0 || nbuilds < 2 || nbuilds == params.nsteps) {
+            amrex::Abort("The Verlet neighbor list is wrong or never reused");
+        }
+        amrex::Print() << "SUCCESS\n";
+    }
+    amrex::Finalize();
+}